@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -16,13 +17,35 @@
 #include <dirent.h>
 #include <sys/sysinfo.h>
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
+#include <stdatomic.h>
 
 // 상수 정의
 #define MAX_WORKERS 16
 #define MAX_PATH_LEN 4096
 #define DEFAULT_WORKERS 4
 #define CHUNK_MIN_SIZE (1024 * 1024)  // 1MB
+#define DEFAULT_CHUNK_SIZE (8 * 1024 * 1024)  // 동적 스케줄링 청크 최대 크기 (8MB)
+#define CHUNKS_PER_WORKER 8             // 자동 청크 크기: 워커당 최소 청크 수
 #define SMALL_FILE_THRESHOLD (4 * 1024 * 1024)  // 4MB 이하는 단일 프로세스
+#define MAX_KEY_LEN 255                 // WorkTask.key 크기 - 1
+#define KEYSTREAM_LANES 64              // 가장 넓은 벡터 폭 (AVX-512)
+#define CACHE_LINE_SIZE 64              // 공유 메모리 필드 정렬 단위
+#define WALKER_THREADS 4                // 디렉터리 탐색 스레드 수
+#define URING_MAX_TASKS 4               // io_uring 워커가 동시에 처리하는 작업 수
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)     // 투명 huge page 크기 (매핑 정렬 단위)
+#define PREFETCH_BLOCK_SIZE (4 * 1024 * 1024)  // 매핑 경로 처리 단위 (다음 블록 미리 읽기)
+#define MAP_WINDOW_SIZE (64 * 1024 * 1024)   // 워커가 한 번에 매핑하는 최대 범위
+#define MAX_NUMA_NODES 64               // 탐지하는 최대 NUMA 노드 수
+#define DIRECT_IO_ALIGN 4096            // O_DIRECT 버퍼/오프셋/길이 정렬 단위
+#define DIRECT_BUF_SIZE (4 * 1024 * 1024)  // direct I/O 버퍼 하나 크기
+#define CHACHA20_KEY_LEN 32             // ChaCha20 키 크기 (SHA-256 출력)
+#define SHA256_DIGEST_LEN 32
+#define STREAM_BUF_SIZE (1024 * 1024)   // 스트리밍 모드 버퍼 하나 크기
+#define STREAM_MAX_BUFFERS (MAX_WORKERS * 2 + 2)  // 스트리밍 버퍼 고리 최대 길이
 
 // 작업 상태
 #define STATUS_IDLE 0
@@ -30,61 +53,493 @@
 #define STATUS_DONE 2
 #define STATUS_ERROR 3
 
-// 작업 정보 구조체
+// 저널 청크 상태 (제자리 변환, 진행 기록)
+#define CHUNK_PENDING 0
+#define CHUNK_ACTIVE 1
+#define CHUNK_DONE 2
+
+#define JOURNAL_MAGIC "CSJRNL01"
+#define JOURNAL_VERSION 2
+#define JOURNAL_BLOCK_SIZE (4 * 1024 * 1024)  // 저널 갱신 단위 (4MB)
+#define JOURNAL_KEY_CHECK_LEN 16
+
+// 청크 컨테이너 형식 (--container)
+#define CONTAINER_MAGIC "CSCTNR01"
+#define CONTAINER_VERSION 2              // 2: 빈 블록 지도 (1도 읽음)
+#define CONTAINER_HEADER_SIZE 4096      // 데이터가 페이지 / O_DIRECT 경계에서 시작
+#define CONTAINER_KEY_CHECK_LEN 16
+#define CONTAINER_COMPLETE 0x1          // 인덱스까지 기록 완료 (헤더 flags)
+#define CONTAINER_CHECKSUMS 0x2         // 인덱스에 청크별 CRC32C 기록 (헤더 flags)
+#define CONTAINER_SPARSE 0x4            // 인덱스에 청크별 빈 블록 비트맵 기록 (헤더 flags)
+#define CONTAINER_HOLE_BITS 32          // 청크 하나를 나누는 빈 블록 수 (비트맵 크기)
+
+// 증분 모드 매니페스트 (--incremental, <출력>.manifest)
+#define MANIFEST_MAGIC "CSMNFT01"
+#define MANIFEST_VERSION 1
+#define MANIFEST_BLOCK_SIZE (1024 * 1024)   // 변경을 판단하고 다시 쓰는 단위
+#define MANIFEST_KEY_CHECK_LEN 16
+#define MANIFEST_DIRTY 0x1                  // 출력을 고치는 중 (헤더 flags, 남아 있으면 믿지 않음)
+
+// 청크 체크섬 계산 위치 (컨테이너: 저장된 암호문 쪽)
+#define CHECKSUM_NONE 0
+#define CHECKSUM_INPUT 1            // 입력 바이트 (컨테이너 복호화: 검증)
+#define CHECKSUM_OUTPUT 2           // 출력 바이트 (컨테이너 암호화: 기록)
+#define CHECKSUM_PIECE (64 * 1024)  // 변환과 CRC를 번갈아 처리하는 단위 (L2 안에 머무는 크기)
+
+// 출력 내구성 정책 (--durability)
+#define DURABILITY_NONE 0           // 동기화 없음 (커널 writeback에 맡김)
+#define DURABILITY_FDATASYNC 1      // 처리 후 출력 파일마다 fdatasync 한 번
+#define DURABILITY_WRITEBEHIND 2    // 처리 중 sync_file_range로 기록 시작 + 끝에 fdatasync
+#define DURABILITY_CHUNK 3          // 청크마다 동기 기록 후 완료 보고 (기본값)
+#define WRITEBEHIND_BLOCK_SIZE (4 * 1024 * 1024)  // write-behind 기록 시작 단위 (4MB)
+
+// 작업 메시지 종류
+#define TASK_RUN 0          // 지정된 청크 하나 처리
+#define TASK_JOB 1          // 공유 커서에서 청크를 가져와 파일 전체 처리
+#define TASK_SHUTDOWN 2     // 워커 종료
+
+// 작업 정보 구조체 (파이프로 전달, 워커는 TASK_SHUTDOWN까지 반복 수신)
 typedef struct {
-    int chunk_id;           // 청크 ID
-    off_t offset;           // 파일 오프셋
-    size_t size;            // 청크 크기
+    int type;               // TASK_RUN / TASK_JOB / TASK_SHUTDOWN
+    int chunk_id;           // 청크 ID (TASK_RUN)
+    off_t offset;           // 파일 오프셋 (TASK_RUN)
+    size_t size;            // 청크 크기 (TASK_RUN)
+    size_t file_size;       // 파일 크기
+    size_t chunk_size;      // 청크 크기 (TASK_JOB, 마지막 청크는 나머지)
+    int num_chunks;         // 전체 청크 수 (TASK_JOB)
     char operation;         // 'e' (encrypt) or 'd' (decrypt)
+    int in_place;           // 제자리 변환 여부 (입력 == 출력)
+    off_t in_data;          // 입력 파일에서 데이터 시작 위치 (컨테이너 헤더 크기, 원시 파일은 0)
+    off_t out_data;         // 출력 파일에서 데이터 시작 위치
+    int checksum;           // 청크 CRC32C 계산 위치 (CHECKSUM_*)
+    int resume;             // 출력의 진행 기록에서 완료된 청크는 건너뜀 (--resume)
     char key[256];          // 암호화 키
+    char input_file[MAX_PATH_LEN];   // 입력 파일 경로
+    char output_file[MAX_PATH_LEN];  // 출력 파일 경로 (제자리 모드는 입력과 동일)
 } WorkTask;
 
+// 저널 헤더 (<파일>.journal 앞부분)
+typedef struct {
+    char magic[8];          // JOURNAL_MAGIC
+    uint32_t version;       // JOURNAL_VERSION
+    char operation;         // 'e' or 'd'
+    uint64_t file_size;     // 대상 파일 크기 (진행 기록은 데이터 크기)
+    uint64_t chunk_size;    // 청크 크기 (마지막 청크는 나머지)
+    uint32_t num_chunks;    // 청크 수
+    // 진행 기록: 이어서 처리해도 같은 결과가 나오는지 재개 전에 확인하는 값
+    uint32_t cipher;        // 암호 엔진 번호 (cipher_id)
+    uint64_t nonce;         // 엔진 nonce (원시 출력은 0)
+    uint64_t source_size;   // 입력 파일 크기
+    int64_t source_mtime;   // 입력 파일 수정 시각 (ns)
+    uint64_t salt;          // 키 확인 값용 임의 값
+    unsigned char key_check[JOURNAL_KEY_CHECK_LEN];
+} JournalHeader;
+
+// 저널 청크 엔트리
+typedef struct {
+    uint64_t done_bytes;    // 청크 시작부터 디스크에 기록 완료된 바이트 수
+    uint32_t state;         // CHUNK_PENDING / CHUNK_ACTIVE / CHUNK_DONE
+    uint32_t checksum;      // 완료된 청크의 CRC32C (컨테이너 암호화를 재개할 때 인덱스에 사용)
+} JournalEntry;
+
+// 매핑된 저널
+typedef struct {
+    int fd;
+    size_t map_size;
+    JournalHeader *header;
+    JournalEntry *entries;
+    char path[MAX_PATH_LEN];
+    atomic_int unresumable; // 다시 실행해도 성공할 수 없는 실패 (진행 기록: 청크 체크섬 불일치)
+} Journal;
+
+// 컨테이너 헤더 (파일 앞 CONTAINER_HEADER_SIZE 바이트 중 앞부분)
+// 배치: [헤더][데이터: 청크 i는 header_size + i * chunk_size][인덱스]
+typedef struct {
+    char magic[8];          // CONTAINER_MAGIC
+    uint32_t version;       // CONTAINER_VERSION
+    uint32_t header_size;   // 데이터 시작 위치
+    uint32_t flags;         // CONTAINER_COMPLETE, CONTAINER_CHECKSUMS, CONTAINER_SPARSE
+    uint32_t cipher;        // 암호 엔진 번호 (cipher_id)
+    uint64_t nonce;         // 파일마다 임의 값 (chacha20 nonce)
+    uint64_t data_size;     // 원본 크기
+    uint64_t chunk_size;    // 청크 크기 (마지막 청크는 나머지)
+    uint32_t num_chunks;
+    uint32_t index_entry_size;  // sizeof(ContainerIndexEntry), 형식이 늘어나도 건너뛸 수 있게
+    uint64_t index_offset;  // 인덱스 시작 위치 (데이터 바로 뒤)
+    unsigned char key_check[CONTAINER_KEY_CHECK_LEN];  // 키 확인 값
+    uint64_t hole_block;    // 빈 블록 비트 하나가 덮는 크기 (CONTAINER_SPARSE, 버전 2)
+} ContainerHeader;
+
+// 컨테이너 인덱스 엔트리 (청크마다 하나)
+typedef struct {
+    uint64_t offset;        // 청크 데이터의 파일 위치
+    uint64_t size;          // 청크에 저장된 바이트 수
+    uint32_t checksum;      // 저장된 청크 바이트의 CRC32C (CONTAINER_CHECKSUMS, 빈 블록 제외)
+    uint32_t holes;         // 빈 블록 비트맵 (CONTAINER_SPARSE): 비트 k가 1이면 청크의 k번째
+                            // hole_block은 원본이 모두 0이라 저장하지 않음 (버전 1은 예약, 0)
+} ContainerIndexEntry;
+
+// 증분 모드 매니페스트 헤더 (뒤에 블록마다 SHA256_DIGEST_LEN 바이트 해시)
+// 해시는 키에서 유도한 값을 앞에 붙인 SHA-256이라 키 없이는 원본 블록을 추측해 맞춰 볼 수 없음
+typedef struct {
+    char magic[8];          // MANIFEST_MAGIC
+    uint32_t version;       // MANIFEST_VERSION
+    uint32_t flags;         // MANIFEST_DIRTY
+    char operation;         // 'e' or 'd'
+    uint32_t cipher;        // 암호 엔진 번호 (cipher_id)
+    uint64_t block_size;
+    uint64_t data_size;     // 해시한 입력 크기 (= 출력 크기)
+    uint64_t num_blocks;
+    int64_t output_mtime;   // 이 매니페스트를 기록할 때 출력 파일의 수정 시각 (ns)
+    uint64_t salt;          // 해시 키 유도용 임의 값
+    unsigned char key_check[MANIFEST_KEY_CHECK_LEN];
+} ManifestHeader;
+
+// 파일 하나의 데이터 배치 (container.c)
+// 원시 파일은 파일 전체가 데이터, 컨테이너는 헤더 뒤 data_size 바이트가 데이터.
+// 키스트림 위치는 데이터 기준이므로 헤더 유무와 무관하게 변환 결과가 같다.
+typedef struct {
+    size_t data_size;       // 변환할 데이터 크기
+    off_t in_data;          // 입력 파일에서 데이터 시작 위치
+    off_t out_data;         // 출력 파일에서 데이터 시작 위치
+    size_t out_size;        // 출력 파일 전체 크기 (컨테이너는 헤더와 인덱스 포함)
+    size_t chunk_size;      // 청크 크기 (컨테이너는 헤더의 값, 원시 파일은 진행 기록을 시작할 때 결정)
+    int write_container;    // 출력을 컨테이너로 기록 (암호화 --container)
+    int checksum;           // 청크 CRC32C 계산 위치 (CHECKSUM_*)
+    uint32_t *checksums;    // 청크별 CRC32C (암호화: 기록할 값, 복호화: 인덱스의 값)
+    uint32_t *holes;        // 청크별 빈 블록 비트맵 (암호화: 입력의 구멍, 복호화: 인덱스의 값)
+    Journal *progress;      // 진행 기록 (<출력>.journal, 제자리 모드는 NULL)
+    int resume;             // 이전 실행의 출력과 진행 기록을 이어서 사용 (--resume)
+    int resumed_chunks;     // 이전 실행에서 완료된 청크 수와 바이트 수
+    size_t resumed_bytes;
+    ContainerHeader header; // 읽은 (또는 기록할) 헤더
+} FileLayout;
+
+// 청크 하나의 CRC32C 누적 상태 (chunk_checksum_init으로 준비)
+// 컨테이너 청크는 빈 블록 비트맵도 함께 가지고 다녀, 변환 경로가 빈 블록을 건너뜀
+typedef struct {
+    int side;               // CHECKSUM_INPUT / CHECKSUM_OUTPUT
+    uint32_t value;
+    uint32_t holes;         // 빈 블록 비트맵 (ContainerIndexEntry.holes)
+    off_t start;            // 청크 시작 (데이터 위치)
+    size_t hole_block;
+} ChunkChecksum;
+
+typedef struct CipherEngine CipherEngine;
+
+// 키스트림 상태 (keystream_init이 선택된 암호 엔진으로 채움)
+typedef struct {
+    const CipherEngine *engine; // 암호 엔진 (xor / chacha20)
+    // xor: 키를 key_len * 64 바이트 주기로 반복한 블록
+    size_t key_len;         // 실제 사용되는 키 길이
+    size_t period;          // 키스트림 주기 (key_len * KEYSTREAM_LANES)
+    unsigned char stream[MAX_KEY_LEN * KEYSTREAM_LANES + KEYSTREAM_LANES]
+        __attribute__((aligned(64)));
+    // chacha20: 초기 상태 (상수, 키, 카운터 자리, nonce)
+    uint32_t chacha[16];
+} KeyStream;
+
+// 암호 엔진: 키 설정과 임의 오프셋 변환 (dst = src ^ keystream[offset ...])
+// 키스트림을 오프셋만으로 계산할 수 있어야 청크를 독립적으로 처리할 수 있음
+struct CipherEngine {
+    const char *name;       // --cipher 이름
+    int (*init)(KeyStream *ks, const char *key, uint64_t nonce);
+    void (*transform)(const KeyStream *ks, unsigned char *dst,
+                      const unsigned char *src, size_t size, uint64_t offset, int nt);
+};
+
+// XOR 커널 (SIMD 폭별 구현)
+typedef void (*xor_kernel_fn)(unsigned char *dst, const unsigned char *src,
+                              size_t size, const unsigned char *stream,
+                              size_t pos, size_t period);
+
+// ChaCha20 다중 블록 커널: nblocks개 블록(카운터 counter부터)의 키스트림을 XOR
+typedef void (*chacha20_blocks_fn)(unsigned char *dst, const unsigned char *src,
+                                   size_t nblocks, const uint32_t state[16],
+                                   uint64_t counter);
+
+typedef struct {
+    const char *name;       // 커널 이름 ("avx2" 등)
+    int (*supported)(void); // 현재 CPU에서 사용 가능 여부
+    xor_kernel_fn fn;       // 커널 함수
+    xor_kernel_fn fn_nt;    // 비시간적 저장 커널 (캐시 우회)
+    chacha20_blocks_fn chacha;  // 같은 명령어 집합의 ChaCha20 커널
+} XorKernel;
+
+// SHA-256 (키 유도)
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;        // 지금까지 입력한 바이트 수
+    unsigned char buffer[64];
+} Sha256;
+
 // 진행 상황 보고 구조체
 typedef struct {
     int chunk_id;           // 청크 ID
     int status;             // 작업 상태
     pid_t worker_pid;       // 워커 PID
     double progress;        // 진행률 (0.0 ~ 1.0)
+    uint32_t checksum;      // STATUS_DONE: 청크 CRC32C (체크섬을 계산한 작업만)
 } ProgressReport;
 
+// 워커별 상태 슬롯
+// 워커 하나만 기록하고 캐시 라인 하나를 단독으로 차지하므로
+// 잠금이 필요 없고 다른 워커와 false sharing이 생기지 않는다.
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE)
+    atomic_uint_fast64_t bytes_done;    // 현재 작업에서 처리한 누적 바이트
+    atomic_int chunks_done;             // 현재 작업에서 완료한 청크 수
+    atomic_int status;                  // 워커 상태 (STATUS_*)
+} WorkerSlot;
+
+_Static_assert(sizeof(WorkerSlot) == CACHE_LINE_SIZE,
+               "WorkerSlot must occupy exactly one cache line");
+
+// 디렉터리 모드: 파일 하나의 작업 정보
+typedef struct FileJob {
+    struct FileJob *next;   // 탐색기 → 스케줄러 전달 목록, 이후 전체 작업 목록
+    char *input_file;       // 입력 경로
+    char *output_file;      // 출력 경로
+    size_t size;            // 파일 크기
+    size_t chunk_size;      // 청크 크기 (작은 파일은 파일 전체)
+    int num_chunks;         // 청크 수
+    int chunks_left;        // 아직 완료되지 않은 청크 수
+    int failed;             // 오류 발생 여부
+} FileJob;
+
+// 재귀 디렉터리 탐색기 (dir_walker.c)
+typedef struct DirWalker DirWalker;
+
+// direct I/O 버퍼 풀 (direct_io.c, 공유 메모리)
+typedef struct DirectPool DirectPool;
+
+// direct I/O로 연 입력 / 출력 파일
+typedef struct {
+    int in_fd;
+    int out_fd;
+    int direct;             // O_DIRECT로 열렸는지 (미지원 파일 시스템은 0)
+    off_t in_data;          // 입력 / 출력 파일에서 데이터 시작 위치 (FileLayout)
+    off_t out_data;
+} DirectFiles;
+
+// 마스터 이벤트 루프가 돌려주는 이벤트 종류
+#define POOL_EVENT_REPORT 0     // 워커의 진행 상황 보고 도착
+#define POOL_EVENT_EXIT 1       // 워커 프로세스 종료 (회수 완료)
+#define POOL_EVENT_INTERRUPT 2  // SIGINT/SIGTERM 수신
+#define POOL_EVENT_WATCH 3      // pool_watch_fd로 등록한 fd가 읽기 가능
+
+// 마스터 이벤트
+typedef struct {
+    int type;                   // POOL_EVENT_*
+    int worker_id;              // REPORT, EXIT: 해당 워커
+    int status;                 // EXIT: waitpid 상태, INTERRUPT: 시그널 번호
+    ProgressReport report;      // REPORT: 수신한 보고
+} PoolEvent;
+
 // 공유 메모리 구조체
+// 쓰기 주체별로 캐시 라인을 나눈다: 마스터가 작업마다 설정하는 필드,
+// 모든 워커가 갱신하는 청크 커서, 워커별 슬롯.
 typedef struct {
-    int total_chunks;                   // 전체 청크 수
-    int completed_chunks;               // 완료된 청크 수
-    int worker_status[MAX_WORKERS];     // 각 워커 상태
-    double worker_progress[MAX_WORKERS]; // 각 워커 진행률
-    pthread_mutex_t mutex;              // 뮤텍스
-    int shutdown_flag;                  // 종료 플래그
+    _Alignas(CACHE_LINE_SIZE)
+    int total_chunks;                   // 전체 청크 수 (마스터만 기록)
+    uint64_t total_bytes;               // 전체 처리 바이트 (마스터만 기록)
+    atomic_int shutdown_flag;           // 종료 플래그
+    _Alignas(CACHE_LINE_SIZE)
+    atomic_int next_chunk;              // 다음에 가져갈 청크 번호 (동적 스케줄링 커서)
+    WorkerSlot workers[MAX_WORKERS];    // 워커별 진행 상황
 } SharedData;
 
 // 함수 선언
 // crypto.c
+void crypto_init(void);
+const char* crypto_kernel_name(void);
+int xor_kernel_count(void);
+const XorKernel* xor_kernel_get(int index);
+int keystream_init(KeyStream *ks, const char *key);
+void xor_transform(const KeyStream *ks, unsigned char *dst,
+                   const unsigned char *src, size_t size, off_t offset);
+void xor_transform_nt(const KeyStream *ks, unsigned char *dst,
+                      const unsigned char *src, size_t size, off_t offset);
+size_t chunk_hole_run(const ChunkChecksum *sum, off_t pos, size_t size, int *hole);
+void xor_transform_sum(const KeyStream *ks, unsigned char *dst,
+                       const unsigned char *src, size_t size, off_t offset,
+                       ChunkChecksum *sum);
+size_t crypto_nt_threshold(void);
+int cipher_select(const char *name);
+const char* cipher_name(void);
+uint32_t cipher_id(void);
+int cipher_use(uint32_t id, uint64_t nonce);
 void xor_encrypt(unsigned char *data, size_t size, const char *key);
 void xor_decrypt(unsigned char *data, size_t size, const char *key);
 
+// chacha20.c
+void chacha20_setup(uint32_t state[16], const unsigned char key[CHACHA20_KEY_LEN],
+                    uint64_t nonce);
+void chacha20_block(const uint32_t state[16], uint64_t counter, unsigned char out[64]);
+void chacha20_blocks_portable(unsigned char *dst, const unsigned char *src,
+                              size_t nblocks, const uint32_t state[16], uint64_t counter);
+void chacha20_blocks_sse2(unsigned char *dst, const unsigned char *src,
+                          size_t nblocks, const uint32_t state[16], uint64_t counter);
+void chacha20_blocks_avx2(unsigned char *dst, const unsigned char *src,
+                          size_t nblocks, const uint32_t state[16], uint64_t counter);
+void chacha20_blocks_avx512(unsigned char *dst, const unsigned char *src,
+                            size_t nblocks, const uint32_t state[16], uint64_t counter);
+void chacha20_transform(chacha20_blocks_fn blocks, const uint32_t state[16],
+                        unsigned char *dst, const unsigned char *src,
+                        size_t size, uint64_t offset);
+
+// crc32c.c
+void crc32c_init(void);
+const char* crc32c_impl_name(void);
+uint32_t crc32c(uint32_t crc, const void *data, size_t len);
+
+// sha256.c
+void sha256_init(Sha256 *ctx);
+void sha256_update(Sha256 *ctx, const void *data, size_t len);
+void sha256_final(Sha256 *ctx, unsigned char digest[SHA256_DIGEST_LEN]);
+void sha256(const void *data, size_t len, unsigned char digest[SHA256_DIGEST_LEN]);
+const char* sha256_impl_name(void);
+
+// container.c
+extern int container_output;
+int container_probe(const char *path);
+int layout_prepare(FileLayout *layout, const char *input_file, char mode,
+                   const char *key, int num_workers, size_t chunk_size);
+int layout_create_output(const FileLayout *layout, const char *output_file);
+int layout_track(FileLayout *layout, Journal *progress, const char *input_file,
+                 const char *output_file, char mode, const char *key,
+                 int num_workers, size_t chunk_size, int resume);
+int layout_chunk_pending(const FileLayout *layout, int chunk_id);
+int layout_chunk_done(const FileLayout *layout, int chunk_id, uint32_t checksum);
+void chunk_checksum_init(ChunkChecksum *sum, int side, int chunk_id);
+int layout_finish(const FileLayout *layout, const char *output_file);
+void layout_release(FileLayout *layout);
+
 // file_utils.c
 int validate_file(const char *filename);
 size_t get_file_size(const char *filename);
 int create_output_file(const char *filename, size_t size);
 int copy_file_direct(const char *src, const char *dst);
-void process_directory(const char *dir_path, int num_workers,
-                       char mode, const char *key);
+void make_output_path(const char *input_file, char mode, char *output, size_t len);
+extern int durability_mode;
+int parse_durability(const char *name);
+const char* durability_name(int mode);
+int durability_open(const char *path);
+int durability_finish(const char *path);
+int skip_in_directory(const char *name, char mode);
+int process_directory(const char *dir_path, int num_workers,
+                      char mode, const char *key, size_t chunk_size);
 
 // ipc.c
+extern int map_populate;
+extern int map_sparse;
 SharedData* init_shared_memory(void);
 void cleanup_shared_memory(SharedData *shared);
+void shared_reset(SharedData *shared, int total_chunks, uint64_t total_bytes);
+int shared_completed_chunks(SharedData *shared);
+uint64_t shared_bytes_done(SharedData *shared);
+void* map_file_range(int fd, off_t offset, size_t size, int writable);
 void* map_file_to_memory(const char *filename, size_t *file_size, int writable);
 void unmap_file(void *addr, size_t size);
 int create_pipes(int pipes_to[][2], int pipes_from[][2], int num_workers);
 void close_unused_pipes(int pipes_to[][2], int pipes_from[][2],
                         int num_workers, int current_worker_id);
+ssize_t read_full(int fd, void *buf, size_t len);
+int write_full(int fd, const void *buf, size_t len);
+int pread_full(int fd, void *buf, size_t len, off_t offset);
+int pwrite_full(int fd, const void *buf, size_t len, off_t offset);
+
+// journal.c
+int journal_exists(const char *target);
+int journal_create(Journal *journal, const char *target, char operation,
+                   size_t file_size, size_t chunk_size, int num_chunks);
+int journal_open(Journal *journal, const char *target);
+int journal_begin(Journal *journal, const char *target, const JournalHeader *run,
+                  const char *source, const char *key);
+int journal_resume(Journal *journal, const char *target, const JournalHeader *run,
+                   const char *source, const char *key);
+void journal_update(Journal *journal, int chunk_id, uint64_t done_bytes, int state);
+void journal_chunk_done(Journal *journal, int chunk_id, uint64_t size,
+                        uint32_t checksum, int sync);
+int journal_chunk_is_done(const Journal *journal, int chunk_id);
+int journal_chunks_done(const Journal *journal);
+void journal_close(Journal *journal);
+void journal_remove(Journal *journal);
+void journal_print_report(const char *target);
 
 // worker.c
+size_t choose_chunk_size(size_t file_size, int num_workers, size_t requested);
+int transform_chunk(const KeyStream *ks, const unsigned char *src_base,
+                    unsigned char *dst_base, size_t map_size,
+                    off_t offset, size_t size, int chunk_id,
+                    Journal *journal, int out_fd, off_t out_data,
+                    ChunkChecksum *sum, SharedData *shared, int worker_id);
+int send_report(int write_fd, int chunk_id, int status, uint32_t checksum);
 void worker_main(int worker_id, int read_fd, int write_fd,
-                 SharedData *shared, const char *filename);
+                 SharedData *shared);
+
+// pool.c
+int pool_start(int num_workers);
+int pool_submit(int worker_id, const WorkTask *task);
+int pool_wait(PoolEvent *event);
+void pool_shutdown(int num_workers);
+int pool_watch_fd(int fd);
+int pool_run_files(DirWalker *walker, int num_workers, char mode,
+                   const char *key, size_t chunk_size, FileJob **files);
+
+// uring_io.c
+extern int use_io_uring;
+int uring_available(void);
+int uring_worker_main(int worker_id, int read_fd, int write_fd, SharedData *shared);
+
+// direct_io.c
+extern int use_direct_io;
+extern DirectPool *direct_pool;
+DirectPool* direct_pool_create(int count);
+void direct_pool_destroy(DirectPool *pool);
+int direct_open(DirectFiles *files, const char *input_file, const char *output_file);
+void direct_close(DirectFiles *files);
+int direct_supported(const char *path);
+int direct_transform_chunk(DirectPool *pool, const KeyStream *ks,
+                           const DirectFiles *files, size_t file_size,
+                           off_t offset, size_t size, ChunkChecksum *sum,
+                           SharedData *shared, int worker_id);
+
+// stream.c
+int stream_open_output(const char *output_file);
+int process_stream(int out_fd, int num_threads, char mode, const char *key);
+
+// range.c
+ssize_t range_read(int fd, const FileLayout *layout, const KeyStream *ks,
+                   uint64_t offset, size_t length, unsigned char *buf);
+int process_range(const char *input_file, int out_fd, const char *key,
+                  uint64_t offset, uint64_t length);
+
+// incremental.c
+int process_incremental(const char *input_file, const char *output_file,
+                        int num_threads, char mode, const char *key,
+                        const FileLayout *layout);
+
+// numa.c
+int affinity_setup(const char *spec);
+void affinity_apply(int worker_id);
+void print_numa_topology(void);
+
+// dir_walker.c
+DirWalker* walker_start(const char *root, char mode, int num_threads);
+int walker_event_fd(DirWalker *walker);
+FileJob* walker_take(DirWalker *walker, int *finished);
+void walker_stop(DirWalker *walker);
+
+// thread_engine.c
+int process_single_file_threaded(const char *input_file, const char *output_file,
+                                 int num_threads, char mode, const char *key,
+                                 int in_place, size_t chunk_size,
+                                 const FileLayout *layout);
 
 // signal_handler.c
 void setup_signal_handlers(void);
+void setup_stop_handlers(void);
 void signal_handler(int signo);
 void sigchld_handler(int signo);
 
@@ -95,5 +550,6 @@ void* progress_thread_func(void *arg);
 void print_system_info(void);
 void print_performance_stats(struct timeval *start, struct timeval *end,
                              size_t file_size);
+void print_fault_stats(size_t bytes);
 
 #endif // CRYPTO_SYSTEM_H
@@ -0,0 +1,358 @@
+#include "crypto_system.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRYPTO_X86 1
+#endif
+
+// ChaCha20 스트림 암호 (--cipher chacha20)
+//
+// 키스트림은 64바이트 블록 단위이고 블록 n은 (키, nonce, 카운터 n)만으로 계산되므로
+// 파일의 임의 오프셋에서 바로 시작할 수 있다. 청크 분할, 동적 스케줄링, 스트리밍 버퍼처럼
+// 오프셋만 넘겨주는 기존 구조가 XOR과 똑같이 동작한다.
+// 카운터는 64비트, nonce는 64비트인 원래 ChaCha20 배치를 사용한다 (파일 크기 제한 없음).
+//
+// 커널은 여러 블록을 벡터 레인에 나눠 동시에 계산한다 (SSE2 4블록, AVX2 8블록, AVX-512 16블록).
+// 레인마다 같은 워드를 담고 있으므로 라운드가 끝나면 전치해서 블록 순서로 XOR한다.
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTER_ROUND(a, b, c, d)                       \
+    a += b; d ^= a; d = ROTL32(d, 16);                  \
+    c += d; b ^= c; b = ROTL32(b, 12);                  \
+    a += b; d ^= a; d = ROTL32(d, 8);                   \
+    c += d; b ^= c; b = ROTL32(b, 7);
+
+static uint32_t load32_le(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void store32_le(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+// 초기 상태: "expand 32-byte k" 상수, 256비트 키, 카운터(12-13), nonce(14-15)
+void chacha20_setup(uint32_t state[16], const unsigned char key[CHACHA20_KEY_LEN],
+                    uint64_t nonce) {
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) {
+        state[4 + i] = load32_le(key + i * 4);
+    }
+    state[12] = 0;
+    state[13] = 0;
+    state[14] = (uint32_t)nonce;
+    state[15] = (uint32_t)(nonce >> 32);
+}
+
+// 키스트림 블록 하나 (블록 번호 counter)
+void chacha20_block(const uint32_t state[16], uint64_t counter, unsigned char out[64]) {
+    uint32_t in[16];
+    memcpy(in, state, sizeof(in));
+    in[12] = (uint32_t)counter;
+    in[13] = (uint32_t)(counter >> 32);
+
+    uint32_t x[16];
+    memcpy(x, in, sizeof(x));
+    for (int i = 0; i < 10; i++) {
+        QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        store32_le(out + i * 4, x[i] + in[i]);
+    }
+}
+
+// 포터블 커널: 블록마다 키스트림을 만들어 XOR
+void chacha20_blocks_portable(unsigned char *dst, const unsigned char *src,
+                              size_t nblocks, const uint32_t state[16], uint64_t counter) {
+    unsigned char block[64];
+    for (size_t b = 0; b < nblocks; b++) {
+        chacha20_block(state, counter + b, block);
+        for (int i = 0; i < 64; i += 8) {
+            uint64_t d, k;
+            memcpy(&d, src + i, 8);
+            memcpy(&k, block + i, 8);
+            d ^= k;
+            memcpy(dst + i, &d, 8);
+        }
+        src += 64;
+        dst += 64;
+    }
+}
+
+#ifdef CRYPTO_X86
+// 레인별 카운터 (하위 / 상위 32비트, 하위가 넘치면 상위에 올림)
+static void lane_counters(uint64_t counter, int lanes, uint32_t *lo, uint32_t *hi) {
+    for (int i = 0; i < lanes; i++) {
+        lo[i] = (uint32_t)(counter + i);
+        hi[i] = (uint32_t)((counter + i) >> 32);
+    }
+}
+
+// SSE2 커널: 4블록 (256바이트) 단위
+#define SSE2_ROTL(v, n) _mm_or_si128(_mm_slli_epi32(v, n), _mm_srli_epi32(v, 32 - (n)))
+#define SSE2_QR(a, b, c, d)                                                             \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = SSE2_ROTL(d, 16);           \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = SSE2_ROTL(b, 12);           \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = SSE2_ROTL(d, 8);            \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = SSE2_ROTL(b, 7);
+
+__attribute__((target("sse2")))
+void chacha20_blocks_sse2(unsigned char *dst, const unsigned char *src,
+                          size_t nblocks, const uint32_t state[16], uint64_t counter) {
+    while (nblocks >= 4) {
+        __m128i in[16], x[16];
+        uint32_t lo[4], hi[4];
+        lane_counters(counter, 4, lo, hi);
+        for (int i = 0; i < 16; i++) {
+            in[i] = _mm_set1_epi32((int)state[i]);
+        }
+        in[12] = _mm_loadu_si128((const __m128i*)lo);
+        in[13] = _mm_loadu_si128((const __m128i*)hi);
+        memcpy(x, in, sizeof(x));
+
+        for (int i = 0; i < 10; i++) {
+            SSE2_QR(x[0], x[4], x[8],  x[12]);
+            SSE2_QR(x[1], x[5], x[9],  x[13]);
+            SSE2_QR(x[2], x[6], x[10], x[14]);
+            SSE2_QR(x[3], x[7], x[11], x[15]);
+            SSE2_QR(x[0], x[5], x[10], x[15]);
+            SSE2_QR(x[1], x[6], x[11], x[12]);
+            SSE2_QR(x[2], x[7], x[8],  x[13]);
+            SSE2_QR(x[3], x[4], x[9],  x[14]);
+        }
+        for (int i = 0; i < 16; i++) {
+            x[i] = _mm_add_epi32(x[i], in[i]);
+        }
+
+        // 워드 4개씩 전치: 그룹 g의 결과는 각 블록의 16 * g 바이트 위치
+        for (int g = 0; g < 4; g++) {
+            __m128i t0 = _mm_unpacklo_epi32(x[g * 4], x[g * 4 + 1]);
+            __m128i t1 = _mm_unpacklo_epi32(x[g * 4 + 2], x[g * 4 + 3]);
+            __m128i t2 = _mm_unpackhi_epi32(x[g * 4], x[g * 4 + 1]);
+            __m128i t3 = _mm_unpackhi_epi32(x[g * 4 + 2], x[g * 4 + 3]);
+            __m128i k[4] = {
+                _mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+                _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3),
+            };
+            for (int b = 0; b < 4; b++) {
+                size_t off = b * 64 + g * 16;
+                __m128i d = _mm_loadu_si128((const __m128i*)(src + off));
+                _mm_storeu_si128((__m128i*)(dst + off), _mm_xor_si128(d, k[b]));
+            }
+        }
+
+        src += 256;
+        dst += 256;
+        counter += 4;
+        nblocks -= 4;
+    }
+
+    chacha20_blocks_portable(dst, src, nblocks, state, counter);
+}
+
+// AVX2 커널: 8블록 (512바이트) 단위, 16 / 8비트 회전은 바이트 셔플
+#define AVX2_ROTL(v, n) _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+#define AVX2_QR(a, b, c, d)                                                                 \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot16); \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = AVX2_ROTL(b, 12);            \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot8);  \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = AVX2_ROTL(b, 7);
+
+__attribute__((target("avx2")))
+void chacha20_blocks_avx2(unsigned char *dst, const unsigned char *src,
+                          size_t nblocks, const uint32_t state[16], uint64_t counter) {
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+
+    while (nblocks >= 8) {
+        __m256i in[16], x[16];
+        uint32_t lo[8], hi[8];
+        lane_counters(counter, 8, lo, hi);
+        for (int i = 0; i < 16; i++) {
+            in[i] = _mm256_set1_epi32((int)state[i]);
+        }
+        in[12] = _mm256_loadu_si256((const __m256i*)lo);
+        in[13] = _mm256_loadu_si256((const __m256i*)hi);
+        memcpy(x, in, sizeof(x));
+
+        for (int i = 0; i < 10; i++) {
+            AVX2_QR(x[0], x[4], x[8],  x[12]);
+            AVX2_QR(x[1], x[5], x[9],  x[13]);
+            AVX2_QR(x[2], x[6], x[10], x[14]);
+            AVX2_QR(x[3], x[7], x[11], x[15]);
+            AVX2_QR(x[0], x[5], x[10], x[15]);
+            AVX2_QR(x[1], x[6], x[11], x[12]);
+            AVX2_QR(x[2], x[7], x[8],  x[13]);
+            AVX2_QR(x[3], x[4], x[9],  x[14]);
+        }
+        for (int i = 0; i < 16; i++) {
+            x[i] = _mm256_add_epi32(x[i], in[i]);
+        }
+
+        // 워드 8개씩 8x8 전치: 절반 h의 결과는 각 블록의 32 * h 바이트 위치
+        // (128비트 반쪽마다 블록 0-3 / 4-7이 들어 있으므로 마지막에 반쪽끼리 합침)
+        for (int h = 0; h < 2; h++) {
+            __m256i *a = &x[h * 8];
+            __m256i t0 = _mm256_unpacklo_epi32(a[0], a[1]);
+            __m256i t1 = _mm256_unpackhi_epi32(a[0], a[1]);
+            __m256i t2 = _mm256_unpacklo_epi32(a[2], a[3]);
+            __m256i t3 = _mm256_unpackhi_epi32(a[2], a[3]);
+            __m256i t4 = _mm256_unpacklo_epi32(a[4], a[5]);
+            __m256i t5 = _mm256_unpackhi_epi32(a[4], a[5]);
+            __m256i t6 = _mm256_unpacklo_epi32(a[6], a[7]);
+            __m256i t7 = _mm256_unpackhi_epi32(a[6], a[7]);
+            __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+            __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+            __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+            __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+            __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+            __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+            __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+            __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+            __m256i k[8] = {
+                _mm256_permute2x128_si256(u0, u4, 0x20), _mm256_permute2x128_si256(u1, u5, 0x20),
+                _mm256_permute2x128_si256(u2, u6, 0x20), _mm256_permute2x128_si256(u3, u7, 0x20),
+                _mm256_permute2x128_si256(u0, u4, 0x31), _mm256_permute2x128_si256(u1, u5, 0x31),
+                _mm256_permute2x128_si256(u2, u6, 0x31), _mm256_permute2x128_si256(u3, u7, 0x31),
+            };
+            for (int b = 0; b < 8; b++) {
+                size_t off = b * 64 + h * 32;
+                __m256i d = _mm256_loadu_si256((const __m256i*)(src + off));
+                _mm256_storeu_si256((__m256i*)(dst + off), _mm256_xor_si256(d, k[b]));
+            }
+        }
+
+        src += 512;
+        dst += 512;
+        counter += 8;
+        nblocks -= 8;
+    }
+
+    chacha20_blocks_sse2(dst, src, nblocks, state, counter);
+}
+
+// AVX-512 커널: 16블록 (1KB) 단위, 회전은 vprold 한 번
+#define AVX512_QR(a, b, c, d)                                                               \
+    a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d, 16);   \
+    c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b, 12);   \
+    a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d, 8);    \
+    c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b, 7);
+
+__attribute__((target("avx512f")))
+void chacha20_blocks_avx512(unsigned char *dst, const unsigned char *src,
+                            size_t nblocks, const uint32_t state[16], uint64_t counter) {
+    while (nblocks >= 16) {
+        __m512i in[16], x[16];
+        uint32_t lo[16], hi[16];
+        lane_counters(counter, 16, lo, hi);
+        for (int i = 0; i < 16; i++) {
+            in[i] = _mm512_set1_epi32((int)state[i]);
+        }
+        in[12] = _mm512_loadu_si512((const void*)lo);
+        in[13] = _mm512_loadu_si512((const void*)hi);
+        memcpy(x, in, sizeof(x));
+
+        for (int i = 0; i < 10; i++) {
+            AVX512_QR(x[0], x[4], x[8],  x[12]);
+            AVX512_QR(x[1], x[5], x[9],  x[13]);
+            AVX512_QR(x[2], x[6], x[10], x[14]);
+            AVX512_QR(x[3], x[7], x[11], x[15]);
+            AVX512_QR(x[0], x[5], x[10], x[15]);
+            AVX512_QR(x[1], x[6], x[11], x[12]);
+            AVX512_QR(x[2], x[7], x[8],  x[13]);
+            AVX512_QR(x[3], x[4], x[9],  x[14]);
+        }
+        for (int i = 0; i < 16; i++) {
+            x[i] = _mm512_add_epi32(x[i], in[i]);
+        }
+
+        // 16x16 전치
+        // 1) 128비트 레인 안에서 4x4 전치: u[4g + r]의 레인 L = 블록 4L + r의 워드 4g..4g+3
+        __m512i u[16];
+        for (int g = 0; g < 4; g++) {
+            __m512i t0 = _mm512_unpacklo_epi32(x[g * 4], x[g * 4 + 1]);
+            __m512i t1 = _mm512_unpackhi_epi32(x[g * 4], x[g * 4 + 1]);
+            __m512i t2 = _mm512_unpacklo_epi32(x[g * 4 + 2], x[g * 4 + 3]);
+            __m512i t3 = _mm512_unpackhi_epi32(x[g * 4 + 2], x[g * 4 + 3]);
+            u[g * 4]     = _mm512_unpacklo_epi64(t0, t2);
+            u[g * 4 + 1] = _mm512_unpackhi_epi64(t0, t2);
+            u[g * 4 + 2] = _mm512_unpacklo_epi64(t1, t3);
+            u[g * 4 + 3] = _mm512_unpackhi_epi64(t1, t3);
+        }
+        // 2) 레인끼리 4x4 전치: 블록 4L + r = [u[r], u[4 + r], u[8 + r], u[12 + r]]의 레인 L
+        for (int r = 0; r < 4; r++) {
+            __m512i s0 = _mm512_shuffle_i32x4(u[r], u[4 + r], 0x44);
+            __m512i s1 = _mm512_shuffle_i32x4(u[r], u[4 + r], 0xEE);
+            __m512i s2 = _mm512_shuffle_i32x4(u[8 + r], u[12 + r], 0x44);
+            __m512i s3 = _mm512_shuffle_i32x4(u[8 + r], u[12 + r], 0xEE);
+            __m512i k[4] = {
+                _mm512_shuffle_i32x4(s0, s2, 0x88), _mm512_shuffle_i32x4(s0, s2, 0xDD),
+                _mm512_shuffle_i32x4(s1, s3, 0x88), _mm512_shuffle_i32x4(s1, s3, 0xDD),
+            };
+            for (int lane = 0; lane < 4; lane++) {
+                size_t off = (lane * 4 + r) * 64;
+                __m512i d = _mm512_loadu_si512((const void*)(src + off));
+                _mm512_storeu_si512((void*)(dst + off), _mm512_xor_si512(d, k[lane]));
+            }
+        }
+
+        src += 1024;
+        dst += 1024;
+        counter += 16;
+        nblocks -= 16;
+    }
+
+    chacha20_blocks_avx2(dst, src, nblocks, state, counter);
+}
+#endif
+
+// 임의 오프셋 변환: 블록 중간에서 시작 / 끝나는 부분은 블록 하나를 만들어 필요한 바이트만 XOR
+void chacha20_transform(chacha20_blocks_fn blocks, const uint32_t state[16],
+                        unsigned char *dst, const unsigned char *src,
+                        size_t size, uint64_t offset) {
+    uint64_t counter = offset / 64;
+    size_t skip = offset % 64;
+    unsigned char block[64];
+
+    if (skip && size > 0) {
+        size_t n = 64 - skip < size ? 64 - skip : size;
+        chacha20_block(state, counter, block);
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = src[i] ^ block[skip + i];
+        }
+        dst += n;
+        src += n;
+        size -= n;
+        counter++;
+    }
+
+    size_t nblocks = size / 64;
+    blocks(dst, src, nblocks, state, counter);
+    dst += nblocks * 64;
+    src += nblocks * 64;
+    size -= nblocks * 64;
+    counter += nblocks;
+
+    if (size > 0) {
+        chacha20_block(state, counter, block);
+        for (size_t i = 0; i < size; i++) {
+            dst[i] = src[i] ^ block[i];
+        }
+    }
+}
@@ -0,0 +1,595 @@
+#define _GNU_SOURCE     // SEEK_DATA, SEEK_HOLE
+#include "crypto_system.h"
+#include <sys/random.h>
+
+// 청크 컨테이너 형식 (--container)
+//
+// 원시 암호문에는 원본 크기, 암호 엔진, 청크 경계, 키 확인 값이 없어서 복호화할 때
+// 같은 옵션을 따로 알고 있어야 한다. 컨테이너는 다음 배치로 이를 파일 안에 기록한다.
+//
+//   [헤더 CONTAINER_HEADER_SIZE][데이터 data_size][인덱스 num_chunks * index_entry_size]
+//
+// 청크 i의 데이터는 header_size + i * chunk_size에 고정 크기로 놓이고 키스트림 위치는
+// 데이터 기준이므로, 워커들은 원시 파일과 같은 경로로 아무 청크나 독립적으로 처리한다.
+// 헤더 크기가 페이지 배수라 데이터 매핑과 O_DIRECT 정렬도 그대로 유지된다.
+// 인덱스는 청크별 위치와 메타데이터를 담아, 이후 압축처럼 청크 크기가
+// 달라지는 형식에서도 청크를 찾는 방법이 바뀌지 않게 한다.
+//
+// 청크 체크섬: 인덱스에 저장된 청크 바이트(암호문)의 CRC32C를 기록한다.
+// 워커가 변환하는 루프 안에서 계산해 완료 보고로 마스터에 보내므로(layout_chunk_done)
+// 암호화할 때 따로 읽지 않고, 복호화할 때도 입력을 읽는 김에 검증해 손상을 청크 단위로 찾는다.
+//
+// 빈 블록 (버전 2, CONTAINER_SPARSE): 청크를 CONTAINER_HOLE_BITS개의 hole_block으로 나누고,
+// 암호화할 때 입력에서 SEEK_DATA / SEEK_HOLE로 찾은 구멍에 완전히 들어가는 블록을
+// 인덱스 엔트리의 비트맵에 기록한다. 이 블록은 변환하지도 쓰지도 않아 컨테이너에도 구멍으로
+// 남고(CRC에서도 제외), 복호화도 비트맵을 보고 건너뛰어 출력에 구멍을 되살린다.
+// 복호화가 컨테이너의 구멍이 아니라 비트맵을 따르므로, 구멍을 채우는 복사(cp, scp)를 거쳐도
+// 결과가 같다. 처리 시간과 디스크 사용량은 논리 크기가 아니라 데이터가 있는 빈 블록 수에 비례한다.
+// (출력 쓰기 매핑은 map_sparse로 4KB 페이지 단위로 채워야 folio 전체가 할당되지 않음)
+//
+// 기록 순서: 헤더(미완료) → 데이터 → 인덱스 → 동기화 → 헤더에 CONTAINER_COMPLETE
+// 중간에 중단된 컨테이너는 완료 표시가 없으므로 복호화가 거부한다.
+
+int container_output = 0;       // --container (fork 전에 main에서 설정)
+
+// 빈 블록 지도가 있는 배치 (layout_prepare가 fork 전에 설정하므로 워커 프로세스도 같은 값을 봄)
+static const FileLayout *hole_layout = NULL;
+
+// 키 확인 값: SHA-256(매직 || nonce || 엔진 번호 || 키)의 앞부분
+static void container_key_check(const ContainerHeader *header, const char *key,
+                                unsigned char out[CONTAINER_KEY_CHECK_LEN]) {
+    unsigned char digest[SHA256_DIGEST_LEN];
+    Sha256 ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, header->magic, sizeof(header->magic));
+    sha256_update(&ctx, &header->nonce, sizeof(header->nonce));
+    sha256_update(&ctx, &header->cipher, sizeof(header->cipher));
+    sha256_update(&ctx, key, strnlen(key, MAX_KEY_LEN));
+    sha256_final(&ctx, digest);
+    memcpy(out, digest, CONTAINER_KEY_CHECK_LEN);
+}
+
+// 헤더 읽기: 컨테이너면 1, 매직이 없으면(원시 파일) 0
+static int container_read_header(int fd, ContainerHeader *header) {
+    memset(header, 0, sizeof(*header));
+    if (pread_full(fd, header, sizeof(*header), 0) == -1) {
+        return 0;   // 헤더보다 짧은 파일
+    }
+    return memcmp(header->magic, CONTAINER_MAGIC, sizeof(header->magic)) == 0;
+}
+
+// 파일이 컨테이너인지 확인 (1: 컨테이너, 0: 원시 파일, -1: 열 수 없음)
+int container_probe(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    ContainerHeader header;
+    int found = container_read_header(fd, &header);
+    close(fd);
+    return found;
+}
+
+// 헤더와 인덱스 검증 (이 버전은 청크가 헤더 뒤에 순서대로 놓인 배치만 처리)
+// 체크섬이 기록된 컨테이너면 *checksums에 청크별 CRC32C 배열을,
+// 빈 블록 지도가 있으면 *holes에 청크별 비트맵을 돌려줌 (그 외 NULL)
+static int container_validate(int fd, size_t file_size, const ContainerHeader *h,
+                              const char *path, uint32_t **checksums, uint32_t **holes) {
+    if (h->version < 1 || h->version > CONTAINER_VERSION) {
+        fprintf(stderr, "Error: '%s' is container version %u (supported: 1-%d)\n",
+                path, h->version, CONTAINER_VERSION);
+        return -1;
+    }
+    if (!(h->flags & CONTAINER_COMPLETE)) {
+        fprintf(stderr, "Error: Container '%s' is incomplete (interrupted while writing)\n",
+                path);
+        return -1;
+    }
+
+    uint64_t num_chunks = h->chunk_size == 0 ? 0 :
+                          (h->data_size + h->chunk_size - 1) / h->chunk_size;
+    if (h->header_size < sizeof(ContainerHeader) || h->header_size % DIRECT_IO_ALIGN != 0 ||
+        h->chunk_size == 0 || h->chunk_size % DIRECT_IO_ALIGN != 0 ||
+        h->num_chunks != num_chunks ||
+        h->index_entry_size < sizeof(ContainerIndexEntry) ||
+        h->index_offset != h->header_size + h->data_size ||
+        file_size != h->index_offset + (uint64_t)h->num_chunks * h->index_entry_size ||
+        ((h->flags & CONTAINER_SPARSE) &&
+         (h->version < 2 || h->hole_block == 0 || h->hole_block % DIRECT_IO_ALIGN != 0 ||
+          h->hole_block * CONTAINER_HOLE_BITS < h->chunk_size))) {
+        fprintf(stderr, "Error: Container '%s' has an invalid header\n", path);
+        return -1;
+    }
+
+    size_t index_size = (size_t)h->num_chunks * h->index_entry_size;
+    unsigned char *index = malloc(index_size ? index_size : 1);
+    if (!index) {
+        perror("malloc");
+        return -1;
+    }
+    int result = 0;
+    if (pread_full(fd, index, index_size, h->index_offset) == -1) {
+        fprintf(stderr, "Error: Cannot read index of container '%s'\n", path);
+        result = -1;
+    }
+
+    *checksums = NULL;
+    *holes = NULL;
+    if (result == 0 && (h->flags & CONTAINER_CHECKSUMS) &&
+        !(*checksums = calloc(h->num_chunks ? h->num_chunks : 1, sizeof(uint32_t)))) {
+        perror("calloc");
+        result = -1;
+    }
+    if (result == 0 && (h->flags & CONTAINER_SPARSE) &&
+        !(*holes = calloc(h->num_chunks ? h->num_chunks : 1, sizeof(uint32_t)))) {
+        perror("calloc");
+        result = -1;
+    }
+
+    for (uint32_t i = 0; result == 0 && i < h->num_chunks; i++) {
+        ContainerIndexEntry entry;
+        memcpy(&entry, index + (size_t)i * h->index_entry_size, sizeof(entry));
+        uint64_t start = (uint64_t)i * h->chunk_size;
+        uint64_t size = h->data_size - start < h->chunk_size ?
+                        h->data_size - start : h->chunk_size;
+        if (entry.offset != h->header_size + start || entry.size != size) {
+            fprintf(stderr, "Error: Container '%s' chunk %u is not in the "
+                    "sequential layout this version reads\n", path, i);
+            result = -1;
+        }
+        if (*checksums) {
+            (*checksums)[i] = entry.checksum;
+        }
+        if (*holes) {
+            // 청크 밖을 가리키는 비트는 손상 (마지막 청크는 블록 수가 적음)
+            uint64_t blocks = (size + h->hole_block - 1) / h->hole_block;
+            if (blocks < CONTAINER_HOLE_BITS && (entry.holes >> blocks) != 0) {
+                fprintf(stderr, "Error: Container '%s' chunk %u has an invalid hole map\n",
+                        path, i);
+                result = -1;
+            }
+            (*holes)[i] = entry.holes;
+        }
+    }
+
+    free(index);
+    if (result == -1) {
+        free(*checksums);
+        free(*holes);
+        *checksums = NULL;
+        *holes = NULL;
+    }
+    return result;
+}
+
+// 청크를 나누는 빈 블록 크기: 청크의 1/CONTAINER_HOLE_BITS를 O_DIRECT 정렬 단위로 올림
+// (정렬 단위 배수라 건너뛴 블록이 파일 시스템 블록 경계에 맞아 구멍으로 남음)
+static uint64_t container_hole_block(uint64_t chunk_size) {
+    uint64_t block = (chunk_size + CONTAINER_HOLE_BITS - 1) / CONTAINER_HOLE_BITS;
+    return (block + DIRECT_IO_ALIGN - 1) & ~(uint64_t)(DIRECT_IO_ALIGN - 1);
+}
+
+// 데이터 [start, end)에 완전히 들어가는 빈 블록을 비트맵에 표시
+static void layout_mark_holes(FileLayout *layout, uint64_t start, uint64_t end) {
+    const ContainerHeader *h = &layout->header;
+    for (uint64_t chunk = start / h->chunk_size;
+         chunk < h->num_chunks && chunk * h->chunk_size < end; chunk++) {
+        uint64_t base = chunk * h->chunk_size;
+        uint64_t limit = h->data_size - base < h->chunk_size ?
+                         h->data_size : base + h->chunk_size;
+        for (int k = 0; k < CONTAINER_HOLE_BITS && base + k * h->hole_block < limit; k++) {
+            uint64_t block_start = base + k * h->hole_block;
+            uint64_t block_end = limit - block_start < h->hole_block ?
+                                 limit : block_start + h->hole_block;
+            if (block_start >= start && block_end <= end) {
+                layout->holes[chunk] |= 1u << k;
+            }
+        }
+    }
+}
+
+// 빈 블록으로 건너뛰는 바이트 수 (안내용)
+static uint64_t layout_hole_bytes(const FileLayout *layout) {
+    const ContainerHeader *h = &layout->header;
+    uint64_t total = 0;
+    for (uint32_t i = 0; layout->holes && i < h->num_chunks; i++) {
+        for (uint32_t bits = layout->holes[i]; bits; bits &= bits - 1) {
+            uint64_t block_start = (uint64_t)i * h->chunk_size +
+                                   (uint64_t)__builtin_ctz(bits) * h->hole_block;
+            total += h->data_size - block_start < h->hole_block ?
+                     h->data_size - block_start : h->hole_block;
+        }
+    }
+    return total;
+}
+
+// 새 컨테이너의 빈 블록 지도: 입력의 구멍을 SEEK_DATA / SEEK_HOLE로 찾아 표시
+// (구멍을 지원하지 않는 파일 시스템은 파일 전체가 데이터로 보고되어 빈 블록 없음)
+static int layout_scan_holes(FileLayout *layout, const char *input_file) {
+    const ContainerHeader *h = &layout->header;
+    free(layout->holes);
+    layout->holes = calloc(h->num_chunks ? h->num_chunks : 1, sizeof(uint32_t));
+    int fd = open(input_file, O_RDONLY | O_CLOEXEC);
+    if (!layout->holes || fd == -1) {
+        perror("Error: Cannot scan input for holes");
+        if (fd != -1) close(fd);
+        return -1;
+    }
+
+    off_t size = h->data_size;
+    for (off_t pos = 0; pos < size; ) {
+        off_t data = lseek(fd, pos, SEEK_DATA);
+        if (data == -1 && errno != ENXIO) {
+            break;      // SEEK_DATA를 지원하지 않음
+        }
+        if (data == -1 || data > size) {
+            data = size;    // 끝까지 구멍
+        }
+        layout_mark_holes(layout, pos, data);
+        if (data == size) {
+            break;
+        }
+        pos = lseek(fd, data, SEEK_HOLE);
+        if (pos == -1) {
+            break;
+        }
+    }
+    close(fd);
+
+    uint64_t hole_bytes = layout_hole_bytes(layout);
+    if (hole_bytes > 0) {
+        printf("Sparse input: %.2f MB of holes will not be stored\n",
+               hole_bytes / 1024.0 / 1024.0);
+        hole_layout = layout;
+        map_sparse = 1;
+    }
+    return 0;
+}
+
+// 입력 파일의 데이터 배치 결정 (main에서 처리 방식을 고르기 전에 한 번)
+//  - 복호화: 입력이 컨테이너면 헤더를 검증하고 키를 확인한 뒤 헤더의 엔진과 nonce 적용
+//  - 암호화 + --container: 새 nonce로 헤더를 준비하고 청크 크기를 고정
+//  - 그 외: 원시 파일 (파일 전체가 데이터)
+int layout_prepare(FileLayout *layout, const char *input_file, char mode,
+                   const char *key, int num_workers, size_t chunk_size) {
+    memset(layout, 0, sizeof(*layout));
+    if (validate_file(input_file) == -1) {
+        return -1;
+    }
+
+    int fd = open(input_file, O_RDONLY | O_CLOEXEC);
+    struct stat statbuf;
+    if (fd == -1 || fstat(fd, &statbuf) == -1) {
+        perror("open");
+        if (fd != -1) close(fd);
+        return -1;
+    }
+
+    ContainerHeader *h = &layout->header;
+    int found = container_read_header(fd, h);
+    if (mode == 'd' && found) {
+        unsigned char check[CONTAINER_KEY_CHECK_LEN];
+        int result = container_validate(fd, statbuf.st_size, h, input_file,
+                                        &layout->checksums, &layout->holes);
+        close(fd);
+        if (result == -1) {
+            return -1;
+        }
+        if (cipher_use(h->cipher, h->nonce) == -1) {
+            fprintf(stderr, "Error: Container '%s' uses unknown cipher %u\n",
+                    input_file, h->cipher);
+            layout_release(layout);
+            return -1;
+        }
+        container_key_check(h, key, check);
+        if (memcmp(check, h->key_check, sizeof(check)) != 0) {
+            fprintf(stderr, "Error: Wrong key for container '%s'\n", input_file);
+            layout_release(layout);
+            return -1;
+        }
+
+        layout->data_size = h->data_size;
+        layout->in_data = h->header_size;
+        layout->out_size = h->data_size;
+        layout->chunk_size = h->chunk_size;
+        layout->checksum = layout->checksums ? CHECKSUM_INPUT : CHECKSUM_NONE;
+        printf("Container: %s, %u chunks of %.2f MB\n", cipher_name(),
+               h->num_chunks, h->chunk_size / 1024.0 / 1024.0);
+        uint64_t hole_bytes = layout_hole_bytes(layout);
+        if (hole_bytes > 0) {
+            printf("Sparse container: %.2f MB of holes will be restored\n",
+                   hole_bytes / 1024.0 / 1024.0);
+            hole_layout = layout;
+            map_sparse = 1;
+        }
+        return 0;
+    }
+    close(fd);
+
+    layout->data_size = statbuf.st_size;
+    layout->out_size = statbuf.st_size;
+    if (mode == 'd' || !container_output) {
+        // 원시 출력에는 구멍을 기록할 곳이 없어 0으로 된 구간도 키스트림으로 채워짐
+        if (mode == 'e' && (uint64_t)statbuf.st_blocks * 512 < (uint64_t)statbuf.st_size) {
+            printf("Note: '%s' is sparse; use --container to keep its holes.\n", input_file);
+        }
+        return 0;
+    }
+
+    // 새 컨테이너: 파일마다 다른 nonce (chacha20은 같은 키로 여러 파일을 암호화해도
+    // 키스트림이 겹치지 않음, xor는 nonce를 쓰지 않음)
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, CONTAINER_MAGIC, sizeof(h->magic));
+    h->version = CONTAINER_VERSION;
+    h->header_size = CONTAINER_HEADER_SIZE;
+    h->flags = CONTAINER_CHECKSUMS | CONTAINER_SPARSE;
+    h->cipher = cipher_id();
+    if (getrandom(&h->nonce, sizeof(h->nonce), 0) != sizeof(h->nonce)) {
+        perror("getrandom");
+        return -1;
+    }
+    h->data_size = layout->data_size;
+    h->chunk_size = choose_chunk_size(layout->data_size, num_workers, chunk_size);
+    h->num_chunks = (layout->data_size + h->chunk_size - 1) / h->chunk_size;
+    h->index_entry_size = sizeof(ContainerIndexEntry);
+    h->index_offset = h->header_size + h->data_size;
+    h->hole_block = container_hole_block(h->chunk_size);
+    container_key_check(h, key, h->key_check);
+    cipher_use(h->cipher, h->nonce);
+
+    layout->checksums = calloc(h->num_chunks ? h->num_chunks : 1, sizeof(uint32_t));
+    if (!layout->checksums) {
+        perror("calloc");
+        return -1;
+    }
+    layout->checksum = CHECKSUM_OUTPUT;
+    layout->write_container = 1;
+    layout->out_data = h->header_size;
+    layout->out_size = h->index_offset + (size_t)h->num_chunks * h->index_entry_size;
+    layout->chunk_size = h->chunk_size;
+    printf("Container: %s, %u chunks of %.2f MB\n", cipher_name(),
+           h->num_chunks, h->chunk_size / 1024.0 / 1024.0);
+    return layout_scan_holes(layout, input_file);
+}
+
+// 재개하는 컨테이너 암호화: 이전 실행이 출력에 기록한 헤더(nonce, 청크 크기)를 그대로 사용
+// 새 nonce로 이어서 암호화하면 앞서 완료된 청크와 키스트림이 달라지므로
+// 청크 크기가 다르면 빈 블록 지도를 이전 헤더의 값으로 다시 만듦 (입력이 같은지는 진행 기록이 확인)
+static int layout_adopt_header(FileLayout *layout, const char *input_file,
+                               const char *output_file, const char *key) {
+    ContainerHeader old;
+    unsigned char check[CONTAINER_KEY_CHECK_LEN];
+    int fd = open(output_file, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        fprintf(stderr, "Error: Cannot resume: cannot open '%s': %s\n",
+                output_file, strerror(errno));
+        return -1;
+    }
+    int found = container_read_header(fd, &old);
+    close(fd);
+
+    container_key_check(&old, key, check);
+    if (!found || old.version != CONTAINER_VERSION ||
+        old.flags != layout->header.flags ||
+        old.hole_block != container_hole_block(old.chunk_size) ||
+        old.data_size != layout->header.data_size || old.chunk_size == 0 ||
+        old.num_chunks != (old.data_size + old.chunk_size - 1) / old.chunk_size ||
+        old.cipher != layout->header.cipher ||
+        memcmp(check, old.key_check, sizeof(check)) != 0) {
+        fprintf(stderr, "Error: Cannot resume: '%s' is not the container "
+                "this run started\n", output_file);
+        return -1;
+    }
+
+    uint32_t *checksums = calloc(old.num_chunks ? old.num_chunks : 1, sizeof(uint32_t));
+    if (!checksums) {
+        perror("calloc");
+        return -1;
+    }
+    int rescan = old.chunk_size != layout->header.chunk_size;
+    free(layout->checksums);
+    layout->checksums = checksums;
+    layout->header = old;
+    layout->header.flags &= ~CONTAINER_COMPLETE;
+    layout->chunk_size = old.chunk_size;
+    layout->out_size = old.index_offset + (size_t)old.num_chunks * old.index_entry_size;
+    cipher_use(old.cipher, old.nonce);
+    return rescan ? layout_scan_holes(layout, input_file) : 0;
+}
+
+// 진행 기록 준비 (제자리 모드가 아닌 파일 하나 처리, main에서 fork 전에)
+// 청크 크기를 여기서 고정해 모든 처리 방식이 같은 청크 번호로 완료를 기록한다.
+//  - 새 실행: <출력>.journal을 새로 만듦
+//  - --resume: 기록과 기존 출력을 검증하고 완료된 청크 수를 layout에 반영
+int layout_track(FileLayout *layout, Journal *progress, const char *input_file,
+                 const char *output_file, char mode, const char *key,
+                 int num_workers, size_t chunk_size, int resume) {
+    if (layout->chunk_size == 0) {
+        layout->chunk_size = choose_chunk_size(layout->data_size, num_workers, chunk_size);
+    }
+    if (resume && layout->write_container &&
+        layout_adopt_header(layout, input_file, output_file, key) == -1) {
+        return -1;
+    }
+
+    JournalHeader run;
+    memset(&run, 0, sizeof(run));
+    run.operation = mode;
+    run.file_size = layout->data_size;
+    run.chunk_size = layout->chunk_size;
+    run.num_chunks = (layout->data_size + layout->chunk_size - 1) / layout->chunk_size;
+    run.cipher = cipher_id();
+    run.nonce = layout->header.nonce;   // 원시 파일은 0
+
+    if (!resume) {
+        if (journal_begin(progress, output_file, &run, input_file, key) == -1) {
+            return -1;
+        }
+        layout->progress = progress;
+        return 0;
+    }
+
+    // 원시 파일의 청크 크기는 실행 옵션(-w, -c)에 따라 달라지므로 기록의 값을 따름
+    if (!layout->write_container && layout->in_data == 0) {
+        run.chunk_size = 0;
+    }
+    int done = journal_resume(progress, output_file, &run, input_file, key);
+    if (done == -1) {
+        return -1;
+    }
+    if (get_file_size(output_file) != layout->out_size) {
+        fprintf(stderr, "Error: Cannot resume: '%s' is not the size the interrupted "
+                "run created\n", output_file);
+        journal_close(progress);
+        return -1;
+    }
+
+    layout->chunk_size = progress->header->chunk_size;
+    layout->progress = progress;
+    layout->resume = 1;
+    layout->resumed_chunks = done;
+    for (uint32_t i = 0; i < progress->header->num_chunks; i++) {
+        if (progress->entries[i].state != CHUNK_DONE) {
+            continue;
+        }
+        layout->resumed_bytes += progress->entries[i].done_bytes;
+        if (layout->checksum == CHECKSUM_OUTPUT) {
+            layout->checksums[i] = progress->entries[i].checksum;
+        }
+    }
+    printf("Resuming: %d of %u chunks already done, %.2f MB left\n",
+           done, progress->header->num_chunks,
+           (layout->data_size - layout->resumed_bytes) / 1024.0 / 1024.0);
+    return 0;
+}
+
+// 이번 실행에서 처리할 청크인지 (재개하면 완료된 청크는 건너뜀)
+int layout_chunk_pending(const FileLayout *layout, int chunk_id) {
+    return !layout->resume || !journal_chunk_is_done(layout->progress, chunk_id);
+}
+
+// 출력 파일 생성 (크기만 확보, 컨테이너는 완료 표시 없는 헤더 기록)
+// 재개하면 이전 실행이 만든 출력을 그대로 사용 (크기는 layout_track에서 확인)
+int layout_create_output(const FileLayout *layout, const char *output_file) {
+    if (layout->resume) {
+        return 0;
+    }
+    int fd = create_output_file(output_file, layout->out_size);
+    if (fd == -1) {
+        return -1;
+    }
+    if (layout->write_container &&
+        pwrite_full(fd, &layout->header, sizeof(layout->header), 0) == -1) {
+        perror("write container header");
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+// 청크 완료 보고 처리 (마스터 또는 스레드 엔진의 작업 스레드에서 청크마다 한 번)
+// 암호화는 인덱스에 기록할 CRC32C를 보관하고, 복호화는 인덱스의 값과 비교 (불일치 시 -1)
+// 통과한 청크는 진행 기록에 완료로 남김
+int layout_chunk_done(const FileLayout *layout, int chunk_id, uint32_t checksum) {
+    if (layout->checksum != CHECKSUM_NONE) {
+        if (chunk_id < 0 || (uint32_t)chunk_id >= layout->header.num_chunks) {
+            fprintf(stderr, "Error: Chunk %d is outside the container\n", chunk_id);
+            return -1;
+        }
+
+        if (layout->checksum == CHECKSUM_OUTPUT) {
+            layout->checksums[chunk_id] = checksum;
+        } else if (layout->checksums[chunk_id] != checksum) {
+            fprintf(stderr, "Error: Container chunk %d is corrupted "
+                    "(CRC32C %08x, index has %08x)\n",
+                    chunk_id, checksum, layout->checksums[chunk_id]);
+            // 입력이 손상되었으므로 이어서 처리해도 같은 청크에서 다시 실패
+            if (layout->progress) {
+                atomic_store(&layout->progress->unresumable, 1);
+            }
+            return -1;
+        }
+    }
+
+    if (layout->progress) {
+        uint64_t start = (uint64_t)chunk_id * layout->chunk_size;
+        uint64_t size = layout->data_size - start < layout->chunk_size ?
+                        layout->data_size - start : layout->chunk_size;
+        journal_chunk_done(layout->progress, chunk_id, size, checksum,
+                           durability_mode == DURABILITY_CHUNK);
+    }
+    return 0;
+}
+
+// 모든 청크가 끝난 뒤 컨테이너 마무리: 인덱스 기록 → 동기화 → 헤더에 완료 표시
+// 내구성 정책이 none이 아니면 완료 표시가 데이터와 인덱스보다 먼저 디스크에 닿지 않는다.
+int layout_finish(const FileLayout *layout, const char *output_file) {
+    if (!layout->write_container) {
+        return 0;
+    }
+
+    const ContainerHeader *h = &layout->header;
+    size_t index_size = (size_t)h->num_chunks * sizeof(ContainerIndexEntry);
+    ContainerIndexEntry *index = calloc(h->num_chunks ? h->num_chunks : 1,
+                                        sizeof(ContainerIndexEntry));
+    int fd = open(output_file, O_WRONLY | O_CLOEXEC);
+    if (!index || fd == -1) {
+        perror("open (container index)");
+        free(index);
+        if (fd != -1) close(fd);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < h->num_chunks; i++) {
+        uint64_t start = (uint64_t)i * h->chunk_size;
+        index[i].offset = h->header_size + start;
+        index[i].size = h->data_size - start < h->chunk_size ?
+                        h->data_size - start : h->chunk_size;
+        index[i].checksum = layout->checksums[i];
+        index[i].holes = layout->holes ? layout->holes[i] : 0;
+    }
+
+    ContainerHeader done = *h;
+    done.flags |= CONTAINER_COMPLETE;
+    int sync = durability_mode != DURABILITY_NONE;
+    int result = 0;
+    if (pwrite_full(fd, index, index_size, h->index_offset) == -1 ||
+        (sync && fdatasync(fd) == -1) ||
+        pwrite_full(fd, &done, sizeof(done), 0) == -1 ||
+        (sync && fdatasync(fd) == -1)) {
+        fprintf(stderr, "Error: Cannot finish container '%s': %s\n",
+                output_file, strerror(errno));
+        result = -1;
+    }
+
+    close(fd);
+    free(index);
+    return result;
+}
+
+void layout_release(FileLayout *layout) {
+    if (hole_layout == layout) {
+        hole_layout = NULL;
+    }
+    free(layout->checksums);
+    free(layout->holes);
+    layout->checksums = NULL;
+    layout->holes = NULL;
+    layout->checksum = CHECKSUM_NONE;
+}
+
+// 청크 하나의 체크섬 상태 준비: 빈 블록 지도가 있으면 청크의 비트맵을 함께 설정
+// (워커 프로세스는 fork 전에 설정된 지도를 물려받아 마스터와 같은 값을 봄)
+void chunk_checksum_init(ChunkChecksum *sum, int side, int chunk_id) {
+    memset(sum, 0, sizeof(*sum));
+    sum->side = side;
+
+    const FileLayout *layout = hole_layout;
+    if (side != CHECKSUM_NONE && layout && chunk_id >= 0 &&
+        (uint32_t)chunk_id < layout->header.num_chunks) {
+        sum->holes = layout->holes[chunk_id];
+        sum->start = (off_t)chunk_id * layout->header.chunk_size;
+        sum->hole_block = layout->header.hole_block;
+    }
+}
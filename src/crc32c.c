@@ -0,0 +1,175 @@
+#include "crypto_system.h"
+
+// CRC32C (Castagnoli, 반사 다항식 0x82F63B78) - 컨테이너 청크 체크섬
+//
+// SSE4.2 crc32 명령은 한 번에 8바이트를 처리하지만 지연 시간이 3사이클이라
+// 한 줄로 이어 계산하면 처리량의 1/3만 쓴다. 그래서 블록을 세 구간으로 나눠
+// 서로 독립인 CRC 세 개를 번갈아 계산하고, 앞 구간의 CRC를 뒤 구간 길이만큼
+// "0을 이어 붙인 것"으로 옮긴 뒤 XOR해 합친다 (CRC는 GF(2)에서 선형).
+// 옮기는 연산은 고정 길이(CRC32C_LONG, CRC32C_SHORT)마다 미리 만든 표로 4번 조회.
+// SSE4.2가 없으면 표 8개로 8바이트씩 처리하는 slicing-by-8 구현을 쓴다.
+
+#define CRC32C_POLY 0x82f63b78
+#define CRC32C_LONG 8192        // 세 구간 중 하나의 길이 (큰 블록)
+#define CRC32C_SHORT 256        // 남은 부분용 짧은 구간
+
+static uint32_t crc32c_table[8][256];       // slicing-by-8
+static uint32_t crc32c_long[4][256];        // CRC32C_LONG바이트만큼 옮기기
+static uint32_t crc32c_short[4][256];       // CRC32C_SHORT바이트만큼 옮기기
+static uint32_t (*crc32c_fn)(uint32_t crc, const unsigned char *data, size_t len);
+
+// GF(2)[x] / P 에서 a * b (반사 표현, x^0이 최상위 비트)
+static uint32_t multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31, p = 0;
+    while (1) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+// x^(8 * len) mod P: CRC를 len바이트의 0 뒤로 옮기는 곱셈 상수
+static uint32_t x8nmodp(size_t len) {
+    uint32_t result = 1u << 31;     // x^0
+    uint32_t power = 1u << 30;      // x^1
+    for (size_t n = len * 8; n; n >>= 1) {
+        if (n & 1) result = multmodp(power, result);
+        power = multmodp(power, power);
+    }
+    return result;
+}
+
+// 옮기기 표: 레지스터 바이트 k의 값 b가 기여하는 결과
+static void crc32c_zeros_table(uint32_t table[4][256], size_t len) {
+    uint32_t op = x8nmodp(len);
+    for (int k = 0; k < 4; k++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            table[k][b] = multmodp(op, b << (8 * k));
+        }
+    }
+}
+
+static inline uint32_t crc32c_shift(uint32_t table[4][256], uint32_t crc) {
+    return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+           table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+// slicing-by-8 (레지스터 값을 그대로 받아 돌려줌, 반전은 crc32c()에서)
+static uint32_t crc32c_portable(uint32_t crc, const unsigned char *data, size_t len) {
+    while (len && ((uintptr_t)data & 7)) {
+        crc = crc32c_table[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        word ^= crc;
+        crc = crc32c_table[7][word & 0xff] ^ crc32c_table[6][(word >> 8) & 0xff] ^
+              crc32c_table[5][(word >> 16) & 0xff] ^ crc32c_table[4][(word >> 24) & 0xff] ^
+              crc32c_table[3][(word >> 32) & 0xff] ^ crc32c_table[2][(word >> 40) & 0xff] ^
+              crc32c_table[1][(word >> 48) & 0xff] ^ crc32c_table[0][word >> 56];
+        data += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = crc32c_table[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+// 세 구간을 번갈아 계산한 뒤 합침 (구간 길이 n바이트, 8의 배수)
+#define CRC32C_3WAY(n, table)                                               \
+    while (len >= 3 * (n)) {                                                \
+        uint64_t crc0 = crc, crc1 = 0, crc2 = 0;                            \
+        const unsigned char *end = data + (n);                              \
+        do {                                                                \
+            uint64_t w0, w1, w2;                                            \
+            memcpy(&w0, data, 8);                                           \
+            memcpy(&w1, data + (n), 8);                                     \
+            memcpy(&w2, data + 2 * (n), 8);                                 \
+            crc0 = _mm_crc32_u64(crc0, w0);                                 \
+            crc1 = _mm_crc32_u64(crc1, w1);                                 \
+            crc2 = _mm_crc32_u64(crc2, w2);                                 \
+            data += 8;                                                      \
+        } while (data < end);                                               \
+        crc = crc32c_shift(table, (uint32_t)crc0) ^ (uint32_t)crc1;         \
+        crc = crc32c_shift(table, crc) ^ (uint32_t)crc2;                    \
+        data += 2 * (n);                                                    \
+        len -= 3 * (n);                                                     \
+    }
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *data, size_t len) {
+    while (len && ((uintptr_t)data & 7)) {
+        crc = _mm_crc32_u8(crc, *data++);
+        len--;
+    }
+
+    CRC32C_3WAY(CRC32C_LONG, crc32c_long)
+    CRC32C_3WAY(CRC32C_SHORT, crc32c_short)
+
+    uint64_t crc64 = crc;
+    while (len >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        len -= 8;
+    }
+    crc = (uint32_t)crc64;
+    while (len--) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+// 표 생성과 구현 선택 (crypto_init에서 fork 전에 한 번)
+void crc32c_init(void) {
+    if (crc32c_fn) {
+        return;
+    }
+
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = crc32c_table[0][n];
+        for (int k = 1; k < 8; k++) {
+            crc = crc32c_table[0][crc & 0xff] ^ (crc >> 8);
+            crc32c_table[k][n] = crc;
+        }
+    }
+    crc32c_zeros_table(crc32c_long, CRC32C_LONG);
+    crc32c_zeros_table(crc32c_short, CRC32C_SHORT);
+
+    crc32c_fn = crc32c_portable;
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        crc32c_fn = crc32c_sse42;
+    }
+#endif
+}
+
+const char* crc32c_impl_name(void) {
+    if (!crc32c_fn) crc32c_init();
+    return crc32c_fn == crc32c_portable ? "portable" : "sse4.2";
+}
+
+// 이어서 계산 가능: crc32c(crc32c(0, a), b) == crc32c(0, a || b)
+uint32_t crc32c(uint32_t crc, const void *data, size_t len) {
+    if (!crc32c_fn) crc32c_init();
+    return ~crc32c_fn(~crc, data, len);
+}
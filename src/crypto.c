@@ -1,20 +1,401 @@
 #include "crypto_system.h"
 
-// XOR 기반 암호화
-// 교육 목적의 간단한 암호화 알고리즘
-// 실제 프로덕션 환경에서는 AES 등의 강력한 알고리즘 사용 권장
-void xor_encrypt(unsigned char *data, size_t size, const char *key) {
-    size_t key_len = strlen(key);
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRYPTO_X86 1
+#endif
 
-    if (key_len == 0) {
-        fprintf(stderr, "Error: Encryption key is empty\n");
-        return;
+// 암호 엔진 (--cipher)
+//  - xor: 교육 목적의 간단한 반복 키 XOR (기본값, 이전 출력과 호환)
+//  - chacha20: 실제 사용을 위한 스트림 암호 (chacha20.c, 키는 SHA-256으로 유도)
+// 두 엔진 모두 키스트림을 파일 오프셋만으로 계산하므로 청크 분할과 스케줄링은 공통이다.
+// 명령어 집합별 커널은 아래 테이블에서 CPU에 맞는 것을 한 번 고르고 두 엔진이 함께 쓴다.
+//
+// XOR 엔진
+// 바이트마다 key[i % key_len]을 계산하면 가장 뜨거운 루프에 나눗셈이 들어간다.
+// 대신 키를 64바이트 배수 주기(key_len * 64)까지 반복해 둔 키스트림 블록을 만들고,
+// 커널은 주기 안의 위치(pos)만 16/32/64바이트씩 전진시키며 XOR한다.
+// 주기가 모든 벡터 폭의 배수이므로 pos가 주기를 넘을 때 한 번 빼주기만 하면 된다.
+
+// XOR 엔진: 키스트림 블록 생성
+static int xor_engine_init(KeyStream *ks, const char *key, uint64_t nonce) {
+    (void)nonce;    // 반복 키 XOR에는 nonce가 없음
+    // WorkTask.key와 동일하게 최대 MAX_KEY_LEN 바이트만 사용
+    size_t key_len = strnlen(key, MAX_KEY_LEN);
+
+    ks->key_len = key_len;
+    ks->period = key_len * KEYSTREAM_LANES;
+
+    // 주기 뒤에 한 벡터 폭만큼 더 채워 두면 pos + 64 까지 경계 검사 없이 읽을 수 있음
+    for (size_t i = 0; i < ks->period + KEYSTREAM_LANES; i++) {
+        ks->stream[i] = (unsigned char)key[i % key_len];
+    }
+
+    return 0;
+}
+
+// 포터블 커널: 8바이트 워드 단위 XOR
+static void xor_kernel_portable(unsigned char *dst, const unsigned char *src,
+                                size_t size, const unsigned char *stream,
+                                size_t pos, size_t period) {
+    while (size >= 8) {
+        uint64_t d, k;
+        memcpy(&d, src, 8);
+        memcpy(&k, stream + pos, 8);
+        d ^= k;
+        memcpy(dst, &d, 8);
+
+        pos += 8;
+        if (pos >= period) pos -= period;
+        src += 8;
+        dst += 8;
+        size -= 8;
     }
 
-    // XOR 연산으로 각 바이트 암호화
     for (size_t i = 0; i < size; i++) {
-        data[i] ^= key[i % key_len];
+        dst[i] = src[i] ^ stream[pos + i];
+    }
+}
+
+#ifdef CRYPTO_X86
+// SSE2 커널: 16바이트 단위
+__attribute__((target("sse2")))
+static void xor_kernel_sse2(unsigned char *dst, const unsigned char *src,
+                            size_t size, const unsigned char *stream,
+                            size_t pos, size_t period) {
+    while (size >= 16) {
+        __m128i d = _mm_loadu_si128((const __m128i*)src);
+        __m128i k = _mm_loadu_si128((const __m128i*)(stream + pos));
+        _mm_storeu_si128((__m128i*)dst, _mm_xor_si128(d, k));
+
+        pos += 16;
+        if (pos >= period) pos -= period;
+        src += 16;
+        dst += 16;
+        size -= 16;
+    }
+
+    xor_kernel_portable(dst, src, size, stream, pos, period);
+}
+
+// AVX2 커널: 32바이트 단위
+__attribute__((target("avx2")))
+static void xor_kernel_avx2(unsigned char *dst, const unsigned char *src,
+                            size_t size, const unsigned char *stream,
+                            size_t pos, size_t period) {
+    while (size >= 32) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)src);
+        __m256i k = _mm256_loadu_si256((const __m256i*)(stream + pos));
+        _mm256_storeu_si256((__m256i*)dst, _mm256_xor_si256(d, k));
+
+        pos += 32;
+        if (pos >= period) pos -= period;
+        src += 32;
+        dst += 32;
+        size -= 32;
+    }
+
+    xor_kernel_portable(dst, src, size, stream, pos, period);
+}
+
+// AVX-512 커널: 64바이트 단위
+__attribute__((target("avx512f")))
+static void xor_kernel_avx512(unsigned char *dst, const unsigned char *src,
+                              size_t size, const unsigned char *stream,
+                              size_t pos, size_t period) {
+    while (size >= 64) {
+        __m512i d = _mm512_loadu_si512((const void*)src);
+        __m512i k = _mm512_loadu_si512((const void*)(stream + pos));
+        _mm512_storeu_si512((void*)dst, _mm512_xor_si512(d, k));
+
+        pos += 64;
+        if (pos >= period) pos -= period;
+        src += 64;
+        dst += 64;
+        size -= 64;
+    }
+
+    xor_kernel_portable(dst, src, size, stream, pos, period);
+}
+
+// 비시간적(non-temporal) 저장 커널
+// LLC보다 큰 출력은 다시 읽히지 않으므로 캐시를 우회해 기록 (read-for-ownership 제거)
+// 스트리밍 저장은 정렬된 주소가 필요하므로 dst가 정렬될 때까지 앞부분은 포터블 커널로 처리
+#define NT_KERNEL(name, target_isa, width, vec_t, loadu, xor_op, stream_op)      \
+__attribute__((target(target_isa)))                                              \
+static void name(unsigned char *dst, const unsigned char *src,                  \
+                 size_t size, const unsigned char *stream,                      \
+                 size_t pos, size_t period) {                                   \
+    size_t head = (width - ((uintptr_t)dst & (width - 1))) & (width - 1);      \
+    if (head > size) head = size;                                               \
+    xor_kernel_portable(dst, src, head, stream, pos, period);                   \
+    pos = (pos + head) % period;                                                \
+    dst += head; src += head; size -= head;                                     \
+    while (size >= width) {                                                     \
+        vec_t d = loadu((const void*)src);                                      \
+        vec_t k = loadu((const void*)(stream + pos));                           \
+        stream_op((void*)dst, xor_op(d, k));                                    \
+        pos += width;                                                           \
+        if (pos >= period) pos -= period;                                       \
+        src += width; dst += width; size -= width;                              \
+    }                                                                           \
+    _mm_sfence();                                                               \
+    xor_kernel_portable(dst, src, size, stream, pos, period);                   \
+}
+
+static inline __attribute__((always_inline, target("sse2")))
+__m128i sse2_loadu(const void *p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline __attribute__((always_inline, target("sse2")))
+void sse2_stream(void *p, __m128i v) { _mm_stream_si128((__m128i*)p, v); }
+static inline __attribute__((always_inline, target("avx2")))
+__m256i avx2_loadu(const void *p) { return _mm256_loadu_si256((const __m256i*)p); }
+static inline __attribute__((always_inline, target("avx2")))
+void avx2_stream(void *p, __m256i v) { _mm256_stream_si256((__m256i*)p, v); }
+
+NT_KERNEL(xor_kernel_sse2_nt, "sse2", 16, __m128i,
+          sse2_loadu, _mm_xor_si128, sse2_stream)
+NT_KERNEL(xor_kernel_avx2_nt, "avx2", 32, __m256i,
+          avx2_loadu, _mm256_xor_si256, avx2_stream)
+NT_KERNEL(xor_kernel_avx512_nt, "avx512f", 64, __m512i,
+          _mm512_loadu_si512, _mm512_xor_si512, _mm512_stream_si512)
+
+static int cpu_has_sse2(void)   { return __builtin_cpu_supports("sse2"); }
+static int cpu_has_avx2(void)   { return __builtin_cpu_supports("avx2"); }
+static int cpu_has_avx512(void) { return __builtin_cpu_supports("avx512f"); }
+#endif
+
+static int cpu_always(void) { return 1; }
+
+// 커널 테이블 (선호 순서)
+static const XorKernel xor_kernels[] = {
+#ifdef CRYPTO_X86
+    { "avx512",   cpu_has_avx512, xor_kernel_avx512,   xor_kernel_avx512_nt,
+      chacha20_blocks_avx512 },
+    { "avx2",     cpu_has_avx2,   xor_kernel_avx2,     xor_kernel_avx2_nt,
+      chacha20_blocks_avx2 },
+    { "sse2",     cpu_has_sse2,   xor_kernel_sse2,     xor_kernel_sse2_nt,
+      chacha20_blocks_sse2 },
+#endif
+    { "portable", cpu_always,     xor_kernel_portable, xor_kernel_portable,
+      chacha20_blocks_portable },
+};
+
+#define NUM_XOR_KERNELS (int)(sizeof(xor_kernels) / sizeof(xor_kernels[0]))
+
+static const XorKernel *active_kernel = NULL;
+
+// 시작 시 CPUID로 사용할 커널 선택
+// CRYPTO_KERNEL 환경 변수로 특정 커널을 강제할 수 있음 (벤치마크용)
+void crypto_init(void) {
+    const char *forced = getenv("CRYPTO_KERNEL");
+
+#ifdef CRYPTO_X86
+    __builtin_cpu_init();
+#endif
+    crc32c_init();  // 청크 체크섬 표와 구현 (워커가 상속)
+
+    for (int i = 0; i < NUM_XOR_KERNELS; i++) {
+        if (!xor_kernels[i].supported()) {
+            continue;
+        }
+        if (forced && strcmp(forced, xor_kernels[i].name) != 0) {
+            continue;
+        }
+        active_kernel = &xor_kernels[i];
+        return;
+    }
+
+    if (forced) {
+        fprintf(stderr, "Warning: CRYPTO_KERNEL=%s is not available, using default\n",
+                forced);
+        unsetenv("CRYPTO_KERNEL");
+        crypto_init();
+        return;
+    }
+
+    active_kernel = &xor_kernels[NUM_XOR_KERNELS - 1];
+}
+
+// 커널 테이블 조회 (벤치마크용)
+int xor_kernel_count(void) {
+    return NUM_XOR_KERNELS;
+}
+
+const XorKernel* xor_kernel_get(int index) {
+    if (index < 0 || index >= NUM_XOR_KERNELS) {
+        return NULL;
     }
+    return &xor_kernels[index];
+}
+
+// 현재 선택된 커널 이름
+const char* crypto_kernel_name(void) {
+    if (!active_kernel) crypto_init();
+    return active_kernel->name;
+}
+
+// XOR 엔진 변환 (offset은 키 주기 안의 위치로 바꿔 커널에 전달)
+static void xor_engine_transform(const KeyStream *ks, unsigned char *dst,
+                                 const unsigned char *src, size_t size,
+                                 uint64_t offset, int nt) {
+    xor_kernel_fn fn = nt ? active_kernel->fn_nt : active_kernel->fn;
+    fn(dst, src, size, ks->stream, offset % ks->key_len, ks->period);
+}
+
+// ChaCha20 엔진: 비밀번호를 SHA-256으로 256비트 키로 유도
+// nonce는 원시 출력에서 0, 컨테이너는 파일마다 헤더에 기록된 임의 값
+static int chacha20_engine_init(KeyStream *ks, const char *key, uint64_t nonce) {
+    unsigned char derived[SHA256_DIGEST_LEN];
+    sha256(key, strnlen(key, MAX_KEY_LEN), derived);
+    chacha20_setup(ks->chacha, derived, nonce);
+    memset(derived, 0, sizeof(derived));
+    return 0;
+}
+
+// ChaCha20은 연산이 병목이라 캐시 우회 저장의 이득이 없으므로 nt는 무시
+static void chacha20_engine_transform(const KeyStream *ks, unsigned char *dst,
+                                      const unsigned char *src, size_t size,
+                                      uint64_t offset, int nt) {
+    (void)nt;
+    chacha20_transform(active_kernel->chacha, ks->chacha, dst, src, size, offset);
+}
+
+// 암호 엔진 테이블 (첫 번째가 기본값)
+// 순서가 컨테이너 헤더의 cipher 번호이므로 새 엔진은 끝에만 추가
+static const CipherEngine cipher_engines[] = {
+    { "xor",      xor_engine_init,      xor_engine_transform },
+    { "chacha20", chacha20_engine_init, chacha20_engine_transform },
+};
+
+#define NUM_CIPHER_ENGINES (int)(sizeof(cipher_engines) / sizeof(cipher_engines[0]))
+
+static const CipherEngine *active_cipher = &cipher_engines[0];
+static uint64_t active_nonce = 0;
+
+// --cipher: 이후 keystream_init이 사용할 엔진 선택 (fork 전에 main에서 호출, 워커가 상속)
+int cipher_select(const char *name) {
+    for (int i = 0; i < NUM_CIPHER_ENGINES; i++) {
+        if (strcmp(name, cipher_engines[i].name) == 0) {
+            active_cipher = &cipher_engines[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* cipher_name(void) {
+    return active_cipher->name;
+}
+
+// 현재 엔진의 번호 (컨테이너 헤더에 기록)
+uint32_t cipher_id(void) {
+    return active_cipher - cipher_engines;
+}
+
+// 컨테이너 헤더의 엔진 번호와 nonce 적용 (fork 전에 main에서 호출, 워커가 상속)
+int cipher_use(uint32_t id, uint64_t nonce) {
+    if (id >= (uint32_t)NUM_CIPHER_ENGINES) {
+        return -1;
+    }
+    active_cipher = &cipher_engines[id];
+    active_nonce = nonce;
+    return 0;
+}
+
+// 키스트림 준비 (선택된 엔진으로 키 설정)
+int keystream_init(KeyStream *ks, const char *key) {
+    if (key[0] == '\0') {
+        fprintf(stderr, "Error: Encryption key is empty\n");
+        return -1;
+    }
+
+    if (!active_kernel) crypto_init();
+    ks->engine = active_cipher;
+    return ks->engine->init(ks, key, active_nonce);
+}
+
+// 키스트림 기반 변환: dst = src ^ keystream[offset ...]
+// offset은 파일 내 절대 위치이므로 청크 경계가 키 주기와 맞지 않아도 결과가 동일함
+// dst == src 이면 제자리 변환
+void xor_transform(const KeyStream *ks, unsigned char *dst,
+                   const unsigned char *src, size_t size, off_t offset) {
+    ks->engine->transform(ks, dst, src, size, (uint64_t)offset, 0);
+}
+
+// 비시간적 저장 버전 (dst != src 인 대용량 출력용)
+void xor_transform_nt(const KeyStream *ks, unsigned char *dst,
+                      const unsigned char *src, size_t size, off_t offset) {
+    ks->engine->transform(ks, dst, src, size, (uint64_t)offset, 1);
+}
+
+// pos부터 빈 블록 여부가 같은 구간의 길이 (최대 size, 범위는 청크 안), *hole에 빈 블록 여부
+// 빈 블록이 없는 청크(원시 파일 포함)는 범위 전체가 데이터 구간 하나
+// sum의 필드만 읽으므로 컨테이너 배치(container.c)와 무관하게 커널 계층에서 사용
+size_t chunk_hole_run(const ChunkChecksum *sum, off_t pos, size_t size, int *hole) {
+    *hole = 0;
+    if (!sum || !sum->holes) {
+        return size;
+    }
+
+    uint64_t rel = pos - sum->start;
+    unsigned k = rel / sum->hole_block;
+    *hole = (sum->holes >> k) & 1;
+    uint64_t run = (k + 1) * sum->hole_block - rel;
+    while (run < size && ++k < CONTAINER_HOLE_BITS &&
+           (int)((sum->holes >> k) & 1) == *hole) {
+        run += sum->hole_block;
+    }
+    return run < size ? run : size;
+}
+
+// 변환하면서 저장 쪽 바이트의 CRC32C를 누적 (sum->side: 입력 또는 출력)
+// CHECKSUM_PIECE씩 변환과 CRC를 번갈아 하므로 CRC가 읽는 바이트는 아직 캐시에 있다
+// (입력 쪽은 변환 전에 계산해 제자리 변환에서도 원래 바이트를 읽음).
+// 출력을 곧바로 다시 읽으므로 캐시를 우회하는 비시간적 저장은 쓰지 않는다.
+// 컨테이너의 빈 블록은 저장하지 않으므로 변환도 CRC 계산도 하지 않고 건너뛴다
+// (출력 쪽 바이트를 건드리지 않아 구멍으로 남음).
+void xor_transform_sum(const KeyStream *ks, unsigned char *dst,
+                       const unsigned char *src, size_t size, off_t offset,
+                       ChunkChecksum *sum) {
+    for (size_t done = 0; done < size; ) {
+        int hole;
+        size_t run = chunk_hole_run(sum, offset + done, size - done, &hole);
+        if (hole) {
+            done += run;
+            continue;
+        }
+
+        size_t len = run < CHECKSUM_PIECE ? run : CHECKSUM_PIECE;
+        if (sum->side == CHECKSUM_INPUT) {
+            sum->value = crc32c(sum->value, src + done, len);
+        }
+        ks->engine->transform(ks, dst + done, src + done, len, (uint64_t)(offset + done), 0);
+        if (sum->side == CHECKSUM_OUTPUT) {
+            sum->value = crc32c(sum->value, dst + done, len);
+        }
+        done += len;
+    }
+}
+
+// 비시간적 저장으로 전환할 출력 크기 기준 (LLC 크기)
+size_t crypto_nt_threshold(void) {
+    static size_t threshold = 0;
+
+    if (threshold == 0) {
+        long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        threshold = llc > 0 ? (size_t)llc : 8 * 1024 * 1024;
+    }
+    return threshold;
+}
+
+void xor_encrypt(unsigned char *data, size_t size, const char *key) {
+    KeyStream ks;
+
+    if (keystream_init(&ks, key) == -1) {
+        return;
+    }
+
+    xor_transform(&ks, data, data, size, 0);
 }
 
 // XOR 기반 복호화
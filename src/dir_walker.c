@@ -0,0 +1,407 @@
+#include "crypto_system.h"
+#include <sys/syscall.h>
+
+// 재귀 디렉터리 탐색기 (교안 ch02, ch11 기반)
+//
+// 디렉터리는 상위 디렉터리 fd 기준 openat으로 열고, 엔트리는 getdents64로 한 번에 여러 개씩 읽는다.
+// d_type으로 디렉터리와 건너뛸 파일을 구분하므로 stat은 처리할 일반 파일(크기 필요)과
+// 종류를 알 수 없는 엔트리에만 fstatat(디렉터리 fd 기준)으로 호출한다.
+// 경로 문자열은 작업에 넘길 파일과 하위 디렉터리에 대해서만 필요한 길이로 만든다.
+//
+// 여러 스레드가 공유 스택에서 디렉터리를 하나씩 가져가 탐색하므로 하위 트리가 스레드들에 나뉜다.
+// 찾은 파일은 WALK_BATCH개씩 모아 넘기고 eventfd로 마스터(epoll)를 깨우므로,
+// 탐색이 끝나기 전에 암호화 작업이 시작된다.
+
+#define WALK_BATCH 256              // 한 번에 넘기는 파일/디렉터리 수
+#define DENTS_BUF_SIZE (64 * 1024)  // getdents64 버퍼
+
+// getdents64가 돌려주는 엔트리 형식
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+// 열린 디렉터리 (하위 디렉터리들이 openat 기준으로 공유, 마지막 사용자가 닫음)
+typedef struct {
+    int fd;
+    atomic_int refs;
+} DirRef;
+
+// 탐색 대기 중인 디렉터리
+typedef struct WalkDir {
+    struct WalkDir *next;
+    DirRef *parent;         // NULL이면 현재 작업 디렉터리 기준
+    char *path;             // 전체 경로 (작업에 넘길 파일 경로의 접두사)
+    const char *name;       // parent 기준 이름 (path 안을 가리킴)
+} WalkDir;
+
+struct DirWalker {
+    char mode;
+    int num_threads;
+    pthread_t threads[WALKER_THREADS];
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    WalkDir *stack;         // 탐색할 디렉터리
+    int active;             // 디렉터리를 탐색 중인 스레드 수
+    int finished;           // 탐색 완료
+    atomic_int stop;        // 중단 요청
+    FileJob *ready;         // 찾았지만 아직 가져가지 않은 파일
+    int event_fd;
+
+    long dirs;              // 통계 (mutex 보호)
+    long skipped;
+    long errors;
+};
+
+static void dir_ref_release(DirRef *ref) {
+    if (ref && atomic_fetch_sub(&ref->refs, 1) == 1) {
+        close(ref->fd);
+        free(ref);
+    }
+}
+
+// 경로 결합 (필요한 길이만큼만 할당)
+static char* path_join(const char *dir, const char *name) {
+    size_t dir_len = strlen(dir);
+    size_t name_len = strlen(name);
+    char *path = malloc(dir_len + 1 + name_len + 1);
+    if (!path) {
+        return NULL;
+    }
+    memcpy(path, dir, dir_len);
+    path[dir_len] = '/';
+    memcpy(path + dir_len + 1, name, name_len + 1);
+    return path;
+}
+
+// 마스터 깨우기
+static void walker_notify(DirWalker *w) {
+    uint64_t one = 1;
+    if (write(w->event_fd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        perror("[Walker] eventfd write");
+    }
+}
+
+// 탐색 스레드별 모음 (WALK_BATCH개마다 공유 목록에 넘김)
+typedef struct {
+    WalkDir *dirs;
+    FileJob *files;
+    FileJob **files_tail;
+    int count;
+    long skipped;
+    long errors;
+} WalkBatch;
+
+static void batch_init(WalkBatch *b) {
+    memset(b, 0, sizeof(*b));
+    b->files_tail = &b->files;
+}
+
+static void batch_flush(DirWalker *w, WalkBatch *b) {
+    if (b->count == 0 && b->skipped == 0 && b->errors == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&w->mutex);
+    int new_dirs = b->dirs != NULL;
+    while (b->dirs) {
+        WalkDir *d = b->dirs;
+        b->dirs = d->next;
+        d->next = w->stack;
+        w->stack = d;
+    }
+    int new_files = b->files != NULL;
+    if (new_files) {
+        *b->files_tail = w->ready;
+        w->ready = b->files;
+    }
+    w->skipped += b->skipped;
+    w->errors += b->errors;
+    pthread_mutex_unlock(&w->mutex);
+
+    if (new_dirs) {
+        pthread_cond_broadcast(&w->cond);  // 쉬고 있는 스레드가 새 하위 트리를 가져가도록
+    }
+    if (new_files) {
+        walker_notify(w);
+    }
+    batch_init(b);
+}
+
+// 일반 파일 하나를 작업으로 추가
+static void batch_add_file(DirWalker *w, WalkBatch *b, const WalkDir *d,
+                           const char *name, size_t size) {
+    // 출력 경로는 입력 경로 + 확장자(.encrypted / .decrypted)
+    FileJob *f = calloc(1, sizeof(FileJob));
+    char *input = path_join(d->path, name);
+    char *output = input ? malloc(strlen(input) + 16) : NULL;
+    if (!f || !output) {
+        free(f);
+        free(input);
+        b->errors++;
+        return;
+    }
+    make_output_path(input, w->mode, output, strlen(input) + 16);
+
+    f->input_file = input;
+    f->output_file = output;
+    f->size = size;
+
+    *b->files_tail = f;
+    b->files_tail = &f->next;
+    if (++b->count >= WALK_BATCH) {
+        batch_flush(w, b);
+    }
+}
+
+// 하위 디렉터리 하나를 탐색 대기열에 추가
+static void batch_add_dir(DirWalker *w, WalkBatch *b, const WalkDir *d,
+                          DirRef *self, const char *name) {
+    WalkDir *child = malloc(sizeof(WalkDir));
+    char *path = path_join(d->path, name);
+    if (!child || !path) {
+        free(child);
+        free(path);
+        b->errors++;
+        return;
+    }
+
+    atomic_fetch_add(&self->refs, 1);
+    child->parent = self;
+    child->path = path;
+    child->name = path + strlen(d->path) + 1;
+    child->next = b->dirs;
+    b->dirs = child;
+    if (++b->count >= WALK_BATCH) {
+        batch_flush(w, b);
+    }
+}
+
+// 디렉터리 하나 탐색
+static void walk_one(DirWalker *w, WalkDir *d, WalkBatch *b) {
+    int parent_fd = d->parent ? d->parent->fd : AT_FDCWD;
+    int fd = openat(parent_fd, d->name,
+                    O_RDONLY | O_DIRECTORY | O_CLOEXEC | (d->parent ? O_NOFOLLOW : 0));
+    dir_ref_release(d->parent);
+    if (fd == -1) {
+        fprintf(stderr, "[Walker] Cannot open '%s': %s\n", d->path, strerror(errno));
+        b->errors++;
+        return;
+    }
+
+    DirRef *self = malloc(sizeof(DirRef));
+    if (!self) {
+        close(fd);
+        b->errors++;
+        return;
+    }
+    self->fd = fd;
+    atomic_init(&self->refs, 1);
+
+    char *buf = malloc(DENTS_BUF_SIZE);
+    long n = 0;
+    while (buf && !atomic_load(&w->stop) &&
+           (n = syscall(SYS_getdents64, fd, buf, DENTS_BUF_SIZE)) > 0) {
+        for (long pos = 0; pos < n; ) {
+            struct linux_dirent64 *ent = (struct linux_dirent64*)(buf + pos);
+            pos += ent->d_reclen;
+
+            const char *name = ent->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+
+            unsigned char type = ent->d_type;
+            if (type == DT_DIR) {
+                batch_add_dir(w, b, d, self, name);
+                continue;
+            }
+            if (type != DT_REG && type != DT_LNK && type != DT_UNKNOWN) {
+                continue;  // 장치, FIFO, 소켓
+            }
+            if (type == DT_REG && skip_in_directory(name, w->mode)) {
+                b->skipped++;
+                continue;
+            }
+
+            // 크기가 필요하거나 종류를 모르는 경우에만 stat (심볼릭 링크는 대상 기준)
+            struct stat statbuf;
+            if (fstatat(fd, name, &statbuf, 0) == -1) {
+                b->errors++;
+                continue;
+            }
+            if (S_ISDIR(statbuf.st_mode)) {
+                if (type == DT_UNKNOWN) {
+                    batch_add_dir(w, b, d, self, name);
+                }
+                continue;  // 디렉터리 심볼릭 링크는 따라가지 않음 (순환 방지)
+            }
+            if (!S_ISREG(statbuf.st_mode)) {
+                continue;
+            }
+            if (type != DT_REG && skip_in_directory(name, w->mode)) {
+                b->skipped++;
+                continue;
+            }
+            batch_add_file(w, b, d, name, statbuf.st_size);
+        }
+    }
+    if (n == -1) {
+        fprintf(stderr, "[Walker] getdents64 '%s': %s\n", d->path, strerror(errno));
+        b->errors++;
+    }
+
+    free(buf);
+    dir_ref_release(self);
+}
+
+// 탐색 스레드: 공유 스택에서 디렉터리를 가져와 탐색
+static void* walker_thread_func(void *arg) {
+    DirWalker *w = arg;
+    WalkBatch batch;
+    batch_init(&batch);
+
+    pthread_mutex_lock(&w->mutex);
+    while (1) {
+        while (!w->stack && w->active > 0 && !atomic_load(&w->stop)) {
+            pthread_cond_wait(&w->cond, &w->mutex);
+        }
+        if (atomic_load(&w->stop) || (!w->stack && w->active == 0)) {
+            break;
+        }
+
+        WalkDir *d = w->stack;
+        w->stack = d->next;
+        w->active++;
+        w->dirs++;
+        pthread_mutex_unlock(&w->mutex);
+
+        walk_one(w, d, &batch);
+        free(d->path);
+        free(d);
+        batch_flush(w, &batch);
+
+        pthread_mutex_lock(&w->mutex);
+        w->active--;
+        if (!w->stack && w->active == 0 && !w->finished) {
+            // 마지막 디렉터리: 모든 스레드를 깨워 종료시키고 마스터에 완료 알림
+            w->finished = 1;
+            pthread_cond_broadcast(&w->cond);
+            walker_notify(w);
+        }
+    }
+    pthread_mutex_unlock(&w->mutex);
+    return NULL;
+}
+
+// 탐색 시작
+DirWalker* walker_start(const char *root, char mode, int num_threads) {
+    DirWalker *w = calloc(1, sizeof(DirWalker));
+    WalkDir *d = malloc(sizeof(WalkDir));
+    if (!w || !d) {
+        perror("malloc");
+        free(w);
+        free(d);
+        return NULL;
+    }
+
+    // 루트 디렉터리 경로 끝의 '/' 제거 (출력 경로에 "//"가 생기지 않도록)
+    d->path = strdup(root);
+    size_t len = strlen(d->path);
+    while (len > 1 && d->path[len - 1] == '/') {
+        d->path[--len] = '\0';
+    }
+    d->name = d->path;
+    d->parent = NULL;
+    d->next = NULL;
+
+    w->mode = mode;
+    w->stack = d;
+    pthread_mutex_init(&w->mutex, NULL);
+    pthread_cond_init(&w->cond, NULL);
+
+    w->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (w->event_fd == -1) {
+        perror("eventfd");
+        free(d->path);
+        free(d);
+        free(w);
+        return NULL;
+    }
+
+    if (num_threads > WALKER_THREADS) num_threads = WALKER_THREADS;
+    for (int i = 0; i < num_threads; i++) {
+        int err = pthread_create(&w->threads[i], NULL, walker_thread_func, w);
+        if (err != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(err));
+            break;
+        }
+        w->num_threads++;
+    }
+
+    if (w->num_threads == 0) {
+        walker_stop(w);
+        return NULL;
+    }
+    return w;
+}
+
+// 마스터가 epoll에 등록할 fd (찾은 파일이 있거나 탐색이 끝나면 읽기 가능)
+int walker_event_fd(DirWalker *walker) {
+    return walker->event_fd;
+}
+
+// 지금까지 찾은 파일 목록을 가져감
+// *finished: 탐색이 끝났고 더 넘겨줄 파일이 없으면 1
+FileJob* walker_take(DirWalker *walker, int *finished) {
+    uint64_t count;
+    if (read(walker->event_fd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+        perror("[Walker] eventfd read");
+    }
+
+    pthread_mutex_lock(&walker->mutex);
+    FileJob *files = walker->ready;
+    walker->ready = NULL;
+    *finished = walker->finished;
+    pthread_mutex_unlock(&walker->mutex);
+    return files;
+}
+
+// 탐색 종료 (중단 시 남은 디렉터리와 파일은 버림) 및 통계 출력
+void walker_stop(DirWalker *walker) {
+    pthread_mutex_lock(&walker->mutex);
+    atomic_store(&walker->stop, 1);
+    pthread_cond_broadcast(&walker->cond);
+    pthread_mutex_unlock(&walker->mutex);
+
+    for (int i = 0; i < walker->num_threads; i++) {
+        pthread_join(walker->threads[i], NULL);
+    }
+
+    printf("[Walker] %ld directories scanned, %ld files skipped, %ld errors\n",
+           walker->dirs, walker->skipped, walker->errors);
+
+    while (walker->stack) {
+        WalkDir *d = walker->stack;
+        walker->stack = d->next;
+        dir_ref_release(d->parent);
+        free(d->path);
+        free(d);
+    }
+    while (walker->ready) {
+        FileJob *f = walker->ready;
+        walker->ready = f->next;
+        free(f->input_file);
+        free(f->output_file);
+        free(f);
+    }
+
+    close(walker->event_fd);
+    pthread_mutex_destroy(&walker->mutex);
+    pthread_cond_destroy(&walker->cond);
+    free(walker);
+}
@@ -0,0 +1,265 @@
+#define _GNU_SOURCE     // O_DIRECT, sync_file_range
+#include "crypto_system.h"
+#include <sched.h>
+
+// Direct I/O 경로 (-O)
+//
+// 페이지 캐시보다 큰 파일을 mmap으로 처리하면 다시 읽지 않을 데이터가 캐시를 채워
+// 같은 머신에서 돌아가는 다른 프로그램의 캐시를 밀어내고, msync도 그만큼 기록해야 한다.
+// 이 경로는 입력과 출력을 O_DIRECT로 열고 정렬된 버퍼로 "pread → XOR → pwrite"를
+// 블록 단위로 진행하므로 캐시를 거치지 않고, 파일 크기와 무관하게 처리량이 일정하다.
+//
+// 버퍼는 fork 전에 공유 메모리에 한 번 만든 풀(DirectPool)에서 블록마다 가져오고
+// 반납하므로 워커(또는 스레드) 사이에서 재사용되고 메모리 사용량이 고정된다.
+// 파일 끝의 정렬되지 않은 꼬리는 정렬 크기로 올려 기록한 뒤 파일 크기를 다시 맞춘다.
+// O_DIRECT를 지원하지 않는 파일 시스템(tmpfs 등)에서는 일반 pread/pwrite를 쓰고
+// 처리한 범위를 POSIX_FADV_DONTNEED로 캐시에서 내린다.
+
+int use_direct_io = 0;          // -O (fork 전에 main에서 설정)
+DirectPool *direct_pool = NULL; // pool_start에서 생성, 워커가 상속
+
+// 공유 메모리의 버퍼 풀
+// 빈 버퍼 목록은 잠금 없는 스택: head 하위 32비트는 맨 위 버퍼 번호 + 1 (0이면 비어 있음),
+// 상위 32비트는 갱신마다 증가하는 태그로 ABA 문제를 막는다.
+struct DirectPool {
+    _Alignas(CACHE_LINE_SIZE)
+    atomic_uint_fast64_t head;
+    int count;                          // 버퍼 수
+    size_t map_size;                    // 매핑 전체 크기
+    atomic_uint next[MAX_WORKERS];      // 스택에서 아래 버퍼 번호 + 1
+};
+
+_Static_assert(sizeof(struct DirectPool) <= DIRECT_IO_ALIGN,
+               "DirectPool header must fit before the first buffer");
+
+static unsigned char* pool_buffer(DirectPool *pool, unsigned index) {
+    return (unsigned char*)pool + DIRECT_IO_ALIGN + (size_t)index * DIRECT_BUF_SIZE;
+}
+
+static uint64_t pool_head(uint64_t old_head, unsigned index) {
+    return (((old_head >> 32) + 1) << 32) | index;
+}
+
+// 버퍼 풀 생성 (MAP_SHARED이므로 fork 후에도 모든 워커가 같은 풀을 사용)
+DirectPool* direct_pool_create(int count) {
+    if (count < 1) count = 1;
+    if (count > MAX_WORKERS) count = MAX_WORKERS;
+
+    // 헤더 뒤 첫 버퍼가 DIRECT_IO_ALIGN 경계에서 시작 (mmap 주소는 페이지 정렬)
+    size_t map_size = DIRECT_IO_ALIGN + (size_t)count * DIRECT_BUF_SIZE;
+    DirectPool *pool = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pool == MAP_FAILED) {
+        perror("mmap direct I/O buffers");
+        return NULL;
+    }
+
+    pool->count = count;
+    pool->map_size = map_size;
+    for (int i = 0; i < count; i++) {
+        atomic_init(&pool->next[i], i);     // i번 아래에는 i-1번 (0이면 바닥)
+    }
+    atomic_init(&pool->head, (uint64_t)count);
+    return pool;
+}
+
+void direct_pool_destroy(DirectPool *pool) {
+    if (pool) {
+        munmap(pool, pool->map_size);
+    }
+}
+
+// 빈 버퍼 가져오기 (버퍼 수가 사용자 수 이상이므로 기다리는 일은 드묾)
+static unsigned char* direct_pool_get(DirectPool *pool) {
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    while (1) {
+        unsigned index = (unsigned)head;
+        if (index == 0) {
+            sched_yield();
+            head = atomic_load_explicit(&pool->head, memory_order_acquire);
+            continue;
+        }
+
+        unsigned below = atomic_load_explicit(&pool->next[index - 1], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                                                  pool_head(head, below),
+                                                  memory_order_acquire,
+                                                  memory_order_acquire)) {
+            return pool_buffer(pool, index - 1);
+        }
+    }
+}
+
+// 버퍼 반납
+static void direct_pool_put(DirectPool *pool, unsigned char *buf) {
+    unsigned index = (buf - pool_buffer(pool, 0)) / DIRECT_BUF_SIZE + 1;
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&pool->next[index - 1], (unsigned)head, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                                                    pool_head(head, index),
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+// 입력 / 출력 파일 열기 (O_DIRECT를 지원하지 않으면 둘 다 일반 I/O로)
+int direct_open(DirectFiles *files, const char *input_file, const char *output_file) {
+    files->direct = 1;
+    files->in_data = files->out_data = 0;
+    files->in_fd = open(input_file, O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if (files->in_fd != -1) {
+        files->out_fd = open(output_file, O_WRONLY | O_DIRECT | O_CLOEXEC);
+        if (files->out_fd == -1) {
+            close(files->in_fd);
+            files->in_fd = -1;
+        }
+    }
+
+    if (files->in_fd == -1 && errno == EINVAL) {
+        files->direct = 0;
+        files->in_fd = open(input_file, O_RDONLY | O_CLOEXEC);
+        if (files->in_fd != -1) {
+            files->out_fd = open(output_file, O_WRONLY | O_CLOEXEC);
+            if (files->out_fd == -1) {
+                close(files->in_fd);
+                files->in_fd = -1;
+            }
+        }
+    }
+
+    if (files->in_fd == -1) {
+        perror("open (direct I/O)");
+        files->out_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void direct_close(DirectFiles *files) {
+    if (files->in_fd != -1) close(files->in_fd);
+    if (files->out_fd != -1) close(files->out_fd);
+    files->in_fd = files->out_fd = -1;
+}
+
+// 파일이 있는 파일 시스템이 O_DIRECT를 지원하는지 확인 (main에서 안내용)
+int direct_supported(const char *path) {
+    int fd = open(path, O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if (fd == -1) {
+        return errno != EINVAL;     // 다른 오류는 나중에 처리 경로에서 보고
+    }
+    close(fd);
+    return 1;
+}
+
+// 청크 하나 변환 (transform_chunk의 direct I/O 버전)
+// offset은 DIRECT_IO_ALIGN의 배수여야 한다 (청크 크기와 컨테이너 헤더 크기는 페이지 배수).
+// offset과 file_size는 데이터 기준이고, 파일 위치는 files->in_data / out_data를 더한 값
+// sum이 있으면 버퍼를 변환하면서 청크의 CRC32C를 계산
+int direct_transform_chunk(DirectPool *pool, const KeyStream *ks,
+                           const DirectFiles *files, size_t file_size,
+                           off_t offset, size_t size, ChunkChecksum *sum,
+                           SharedData *shared, int worker_id) {
+    unsigned char *buf = direct_pool_get(pool);
+    int result = 0;
+
+    for (size_t processed = 0; processed < size && result == 0; ) {
+        off_t pos = offset + processed;
+        size_t len = size - processed < DIRECT_BUF_SIZE ? size - processed : DIRECT_BUF_SIZE;
+
+        // 컨테이너의 빈 블록은 읽지도 쓰지도 않음 (출력에 구멍으로 남김)
+        int hole;
+        len = chunk_hole_run(sum, pos, len, &hole);
+        if (hole) {
+            processed += len;
+            if (shared) {
+                atomic_fetch_add_explicit(&shared->workers[worker_id].bytes_done,
+                                          len, memory_order_relaxed);
+            }
+            continue;
+        }
+
+        // O_DIRECT는 길이도 정렬되어야 하므로 꼬리는 올려서 요청 (EOF에서 짧게 읽힘)
+        size_t io_len = files->direct ?
+                        (len + DIRECT_IO_ALIGN - 1) & ~(size_t)(DIRECT_IO_ALIGN - 1) : len;
+
+        size_t got = 0;
+        while (got < len) {
+            ssize_t n = pread(files->in_fd, buf + got, io_len - got,
+                              files->in_data + pos + got);
+            if (n == -1 && errno == EINTR) continue;
+            if (n <= 0) {
+                fprintf(stderr, "[Worker %d] pread: %s\n", worker_id,
+                        n == 0 ? "unexpected end of file" : strerror(errno));
+                result = -1;
+                break;
+            }
+            got += n;
+        }
+        if (result == -1) {
+            break;
+        }
+
+        if (sum) {
+            xor_transform_sum(ks, buf, buf, len, pos, sum);
+        } else {
+            xor_transform(ks, buf, buf, len, pos);
+        }
+        memset(buf + len, 0, io_len - len);
+
+        size_t put = 0;
+        while (put < io_len) {
+            ssize_t n = pwrite(files->out_fd, buf + put, io_len - put,
+                               files->out_data + pos + put);
+            if (n == -1 && errno == EINTR) continue;
+            if (n <= 0) {
+                fprintf(stderr, "[Worker %d] pwrite: %s\n", worker_id,
+                        n == 0 ? "no progress" : strerror(errno));
+                result = -1;
+                break;
+            }
+            put += n;
+        }
+        processed += len;
+
+        // 진행률 업데이트 (자기 슬롯만 갱신하므로 잠금 불필요)
+        if (result == 0 && shared) {
+            atomic_fetch_add_explicit(&shared->workers[worker_id].bytes_done,
+                                      len, memory_order_relaxed);
+        }
+    }
+
+    direct_pool_put(pool, buf);
+    if (result == -1) {
+        return -1;
+    }
+
+    // 꼬리를 올려 쓴 만큼 늘어난 파일 크기를 되돌림 (파일 끝 청크만 해당)
+    // 컨테이너는 인덱스 자리까지 잘리지만 인덱스는 모든 청크가 끝난 뒤에 기록됨
+    if (files->direct && (size_t)offset + size == file_size &&
+        file_size % DIRECT_IO_ALIGN != 0 &&
+        ftruncate(files->out_fd, files->out_data + file_size) == -1) {
+        perror("ftruncate");
+        return -1;
+    }
+
+    // O_DIRECT도 장치 캐시와 메타데이터는 남으므로 mmap 경로의 msync와 같은 시점에 동기화
+    // (다른 정책은 durability_finish가 실행 끝에 한 번 동기화)
+    if (durability_mode == DURABILITY_CHUNK && fdatasync(files->out_fd) == -1) {
+        perror("fdatasync");
+        return -1;
+    }
+
+    // 일반 I/O로 대체된 경우: 기록이 끝난 범위를 캐시에서 내림
+    // (더티 페이지는 내려가지 않으므로 청크 동기화를 하지 않은 정책에서는 기록을 기다림)
+    if (!files->direct) {
+        if (durability_mode != DURABILITY_CHUNK) {
+            sync_file_range(files->out_fd, files->out_data + offset, size,
+                            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                            SYNC_FILE_RANGE_WAIT_AFTER);
+        }
+        posix_fadvise(files->in_fd, files->in_data + offset, size, POSIX_FADV_DONTNEED);
+        posix_fadvise(files->out_fd, files->out_data + offset, size, POSIX_FADV_DONTNEED);
+    }
+
+    return 0;
+}
@@ -1,5 +1,8 @@
 #include "crypto_system.h"
 
+// 전역 변수 (extern으로 main.c에서 선언된 것 사용)
+extern SharedData *shared_data;
+
 // 파일 유효성 검증 (교안 ch03, ch04 기반)
 int validate_file(const char *filename) {
     // access() 함수로 파일 존재 확인
@@ -110,8 +113,8 @@ int copy_file_direct(const char *src, const char *dst) {
     // 메모리 복사 (매우 빠름)
     memcpy(dst_map, src_map, file_size);
 
-    // 디스크에 동기화
-    if (msync(dst_map, file_size, MS_SYNC) == -1) {
+    // 디스크에 동기화 (--durability none이면 커널 writeback에 맡김)
+    if (durability_mode != DURABILITY_NONE && msync(dst_map, file_size, MS_SYNC) == -1) {
         perror("msync");
         goto cleanup;
     }
@@ -134,62 +137,191 @@ cleanup:
     return ret;
 }
 
-// 디렉터리 처리 (교안 ch02 기반)
-void process_directory(const char *dir_path, int num_workers,
-                       char mode, const char *key) {
-    DIR *dir = opendir(dir_path);
-    if (dir == NULL) {
-        perror("opendir");
+// 출력 내구성 정책 (--durability, fork 전에 main에서 설정)
+// 완료를 보고한 시점에 디스크에 있음이 보장되는 범위:
+//  - chunk: 청크마다 (완료 보고된 청크는 항상 디스크에 있음, 제자리 모드의 저널이 의존)
+//  - fdatasync: 실행이 성공으로 끝나면 출력 전체 (도중에 중단되면 출력 내용은 보장 없음)
+//  - writebehind: fdatasync와 같음. 처리 중에 블록마다 기록을 시작해 더티 페이지를 줄이고
+//    마지막 fdatasync를 짧게 함
+//  - none: 없음 (성공해도 커널이 기록하기 전에 시스템이 멈추면 출력 일부가 유실될 수 있음)
+int durability_mode = DURABILITY_CHUNK;
+
+static const char *durability_names[] = { "none", "fdatasync", "writebehind", "chunk" };
+
+// 정책 이름 파싱 (알 수 없는 이름은 -1)
+int parse_durability(const char *name) {
+    for (int i = 0; i < (int)(sizeof(durability_names) / sizeof(durability_names[0])); i++) {
+        if (strcmp(name, durability_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* durability_name(int mode) {
+    return durability_names[mode];
+}
+
+// write-behind용 출력 파일 fd (다른 정책이면 -1)
+// 매핑 경로는 fd를 닫으므로 sync_file_range를 위해 따로 연다
+int durability_open(const char *path) {
+    if (durability_mode != DURABILITY_WRITEBEHIND) {
+        return -1;
+    }
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        perror("open (write-behind)");
+    }
+    return fd;
+}
+
+// 실행 끝 동기화: fdatasync / writebehind 정책에서 출력 파일마다 한 번
+int durability_finish(const char *path) {
+    if (durability_mode != DURABILITY_FDATASYNC && durability_mode != DURABILITY_WRITEBEHIND) {
+        return 0;
+    }
+
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        perror("open (fdatasync)");
+        return -1;
+    }
+    int ret = fdatasync(fd);
+    if (ret == -1) {
+        fprintf(stderr, "fdatasync '%s': %s\n", path, strerror(errno));
+    }
+    close(fd);
+    return ret;
+}
+
+// 출력 파일명 생성
+// 암호화: <입력>.encrypted
+// 복호화: .encrypted 확장자 제거 후 .decrypted 추가 (원본을 덮어쓰지 않도록)
+void make_output_path(const char *input_file, char mode, char *output, size_t len) {
+    if (mode == 'e') {
+        snprintf(output, len, "%s.encrypted", input_file);
         return;
     }
 
-    struct dirent *entry;
-    int file_count = 0;
+    const char *ext = strstr(input_file, ".encrypted");
+    if (ext) {
+        snprintf(output, len, "%.*s.decrypted", (int)(ext - input_file), input_file);
+    } else {
+        snprintf(output, len, "%s.decrypted", input_file);
+    }
+}
+
+// 이름이 suffix로 끝나는지 확인
+static int has_suffix(const char *name, const char *suffix) {
+    size_t name_len = strlen(name);
+    size_t suffix_len = strlen(suffix);
+    return name_len >= suffix_len && strcmp(name + name_len - suffix_len, suffix) == 0;
+}
+
+// 디렉터리 모드에서 건너뛸 파일인지 확인
+// 암호화: 이전 실행의 출력(.encrypted, .decrypted)은 다시 처리하지 않음
+// 복호화: .encrypted 파일만 처리 (평문 X와 X.encrypted가 같은 X.decrypted에 쓰지 않도록)
+int skip_in_directory(const char *name, char mode) {
+    if (mode == 'e') {
+        return has_suffix(name, ".encrypted") || has_suffix(name, ".decrypted");
+    }
+    return !has_suffix(name, ".encrypted");
+}
+
+// 디렉터리 처리 (교안 ch02 기반)
+// 디렉터리 트리를 재귀적으로 탐색하면서 찾은 일반 파일을 바로 워커 풀에 보낸다.
+// 찾은 파일 중 큰 파일부터 작업을 내보내고, SMALL_FILE_THRESHOLD 이상인 파일만 청크로 나눈다.
+int process_directory(const char *dir_path, int num_workers,
+                      char mode, const char *key, size_t chunk_size) {
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    struct stat statbuf;
+    if (stat(dir_path, &statbuf) == -1 || !S_ISDIR(statbuf.st_mode)) {
+        fprintf(stderr, "Error: '%s' is not a directory\n", dir_path);
+        return -1;
+    }
 
     printf("\n=== Processing Directory: %s ===\n", dir_path);
+    printf("Mode: %s\n", mode == 'e' ? "Encryption" : "Decryption");
+    printf("Master PID: %d\n", getpid());
+    printf("Workers: %d, walker threads: %d\n\n", num_workers, WALKER_THREADS);
 
-    while ((entry = readdir(dir)) != NULL) {
-        // "."과 ".." 건너뛰기
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
+    // 공유 메모리 초기화 및 워커 풀 생성
+    shared_data = init_shared_memory();
+    if (!shared_data) {
+        return -1;
+    }
+    setup_signal_handlers();
+    if (pool_start(num_workers) == -1) {
+        cleanup_shared_memory(shared_data);
+        shared_data = NULL;
+        return -1;
+    }
 
-        char filepath[MAX_PATH_LEN];
-        snprintf(filepath, sizeof(filepath), "%s/%s", dir_path, entry->d_name);
-
-        // 일반 파일만 처리
-        struct stat statbuf;
-        if (stat(filepath, &statbuf) == 0 && S_ISREG(statbuf.st_mode)) {
-            printf("\n[%d] Processing: %s\n", ++file_count, entry->d_name);
-
-            // 출력 파일명 생성
-            char output_file[MAX_PATH_LEN];
-            if (mode == 'e') {
-                snprintf(output_file, sizeof(output_file), "%s.encrypted", filepath);
-            } else {
-                // .encrypted 확장자 제거
-                if (strstr(entry->d_name, ".encrypted")) {
-                    snprintf(output_file, sizeof(output_file), "%s/%s",
-                             dir_path, entry->d_name);
-                    char *ext = strstr(output_file, ".encrypted");
-                    if (ext) *ext = '\0';
-                    strcat(output_file, ".decrypted");
-                } else {
-                    snprintf(output_file, sizeof(output_file), "%s.decrypted", filepath);
-                }
-            }
+    // 탐색 스레드는 fork 뒤에 시작 (막아 둔 시그널 마스크를 물려받아 signalfd로만 처리됨)
+    FileJob *files = NULL;
+    int failed = -1;
+    DirWalker *walker = walker_start(dir_path, mode, WALKER_THREADS);
+    if (walker) {
+        printf("=== Scheduling files largest-first as they are found ===\n");
+        failed = pool_run_files(walker, num_workers, mode, key, chunk_size, &files);
+    }
 
-            // TODO: process_single_file() 호출 (main.c에서 구현 예정)
-            // process_single_file(filepath, output_file, num_workers, mode, key);
-            printf("    Output: %s\n", output_file);
-        }
+    pool_shutdown(num_workers);
+    if (walker) {
+        walker_stop(walker);
     }
+    cleanup_shared_memory(shared_data);
+    shared_data = NULL;
+
+    gettimeofday(&end, NULL);
 
-    closedir(dir);
+    int file_count = 0;
+    int failed_shown = 0;
+    uint64_t done_bytes = 0;
+    while (files) {
+        FileJob *f = files;
+        files = f->next;
+
+        file_count++;
+        if (f->failed) {
+            if (++failed_shown <= 10) {
+                fprintf(stderr, "Failed: %s\n", f->input_file);
+            }
+        } else {
+            done_bytes += f->size;
+        }
+        free(f->input_file);
+        free(f->output_file);
+        free(f);
+    }
 
+    if (failed_shown > 10) {
+        fprintf(stderr, "... and %d more\n", failed_shown - 10);
+    }
+    if (failed == -1) {
+        return -1;
+    }
     if (file_count == 0) {
         printf("No regular files found in directory.\n");
-    } else {
-        printf("\n=== Total %d files processed ===\n", file_count);
+        return 0;
     }
+
+    // 전체 처리량 출력
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_usec - start.tv_usec) / 1000000.0;
+    double mb_size = done_bytes / (1024.0 * 1024.0);
+
+    printf("\n=== Directory Statistics ===\n");
+    printf("Files processed: %d / %d\n", file_count - failed, file_count);
+    printf("Data processed: %.2f MB\n", mb_size);
+    printf("Processing time: %.3f seconds\n", elapsed);
+    printf("Throughput: %.2f MB/s, %.1f files/s\n",
+           mb_size / elapsed, (file_count - failed) / elapsed);
+    print_fault_stats(done_bytes);
+    printf("Workers: %d\n", num_workers);
+    printf("============================\n");
+
+    return failed == 0 ? 0 : -1;
 }
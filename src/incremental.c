@@ -0,0 +1,397 @@
+#include "crypto_system.h"
+#include <sys/random.h>
+
+// 증분 모드 (--incremental)
+//
+// 같은 데이터를 주기적으로 다시 암호화할 때 대부분의 블록은 바뀌지 않는다.
+// 출력 옆 <출력>.manifest에 입력 블록(MANIFEST_BLOCK_SIZE)마다 해시를 남겨 두고,
+// 다음 실행은 입력을 읽어 해시만 비교한 뒤 해시가 바뀐 블록만 변환해 기존 출력에 덮어쓴다.
+// 키스트림이 위치만으로 정해지므로 바뀌지 않은 블록의 출력은 다시 계산해도 같다.
+// 입력은 모두 읽어야 하지만 출력 쓰기는 바뀐 양에 비례하고, 출력은 읽지 않는다.
+//
+// 스레드들이 원자적 커서에서 블록 번호를 가져가 pread → 해시 → (바뀌었으면) 변환 → pwrite.
+//
+// 매니페스트를 믿는 조건: 완료 표시가 깨끗하고, 같은 방향 / 엔진 / 블록 크기 / 키이며,
+// 출력 파일의 크기와 수정 시각이 매니페스트를 기록할 때와 같음 (다른 실행이 출력을 고치지 않음).
+// 출력을 고치기 전에 이전 매니페스트에 MANIFEST_DIRTY를 기록(동기화)하고,
+// 출력을 동기화한 뒤 새 매니페스트를 임시 파일에 써서 rename으로 바꾼다.
+// 중간에 중단되면 다음 실행은 매니페스트를 믿지 않고 모든 블록을 다시 쓴다.
+
+// 스레드 간 공유 작업 정보
+typedef struct {
+    const KeyStream *ks;
+    int in_fd;
+    int out_fd;
+    size_t data_size;
+    int num_blocks;
+    Sha256 hash_base;                   // 해시 키 블록까지 흡수한 상태 (블록마다 복사)
+    const unsigned char *old_hashes;    // 이전 매니페스트 (믿을 수 없으면 NULL)
+    uint64_t old_blocks;
+    unsigned char *hashes;              // 이번 입력의 블록 해시
+    atomic_int next_block;
+    atomic_int changed;                 // 다시 쓴 블록 수
+    atomic_uint_fast64_t bytes_written;
+    atomic_int errors;
+} IncrementalJob;
+
+typedef struct {
+    int thread_id;
+    IncrementalJob *job;
+} IncrementalArg;
+
+// 해시 키: SHA-256(매직 || salt || 키), 키 확인 값은 해시 키의 SHA-256 앞부분
+static void manifest_keys(const ManifestHeader *header, const char *key,
+                          unsigned char hash_key[SHA256_DIGEST_LEN],
+                          unsigned char check[MANIFEST_KEY_CHECK_LEN]) {
+    unsigned char digest[SHA256_DIGEST_LEN];
+    Sha256 ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, MANIFEST_MAGIC, sizeof(header->magic));
+    sha256_update(&ctx, &header->salt, sizeof(header->salt));
+    sha256_update(&ctx, key, strnlen(key, MAX_KEY_LEN));
+    sha256_final(&ctx, hash_key);
+
+    sha256(hash_key, SHA256_DIGEST_LEN, digest);
+    memcpy(check, digest, MANIFEST_KEY_CHECK_LEN);
+}
+
+static int64_t file_mtime_ns(const struct stat *statbuf) {
+    return (int64_t)statbuf->st_mtim.tv_sec * 1000000000 + statbuf->st_mtim.tv_nsec;
+}
+
+// 이전 매니페스트 읽기: 이번 실행에서 믿을 수 있으면 블록 해시 배열 (그 외 NULL)
+// *old에는 읽은 헤더 (믿을 수 있을 때 salt를 이어서 사용)
+static unsigned char* manifest_load(const char *path, int out_fd, const ManifestHeader *run,
+                                    const char *key, ManifestHeader *old) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        printf("Note: No manifest for this output yet, writing all blocks.\n");
+        return NULL;
+    }
+
+    const char *reason = NULL;
+    unsigned char hash_key[SHA256_DIGEST_LEN];
+    unsigned char check[MANIFEST_KEY_CHECK_LEN];
+    struct stat manifest_stat, out_stat;
+    if (pread_full(fd, old, sizeof(*old), 0) == -1 ||
+        memcmp(old->magic, MANIFEST_MAGIC, sizeof(old->magic)) != 0 ||
+        old->version != MANIFEST_VERSION || old->block_size == 0 ||
+        old->num_blocks != (old->data_size + old->block_size - 1) / old->block_size ||
+        fstat(fd, &manifest_stat) == -1 ||
+        (uint64_t)manifest_stat.st_size != sizeof(*old) + old->num_blocks * SHA256_DIGEST_LEN) {
+        reason = "manifest is damaged or from another version";
+    } else if (old->flags & MANIFEST_DIRTY) {
+        reason = "the previous incremental run did not finish";
+    } else if (old->operation != run->operation || old->cipher != run->cipher ||
+               old->block_size != run->block_size) {
+        reason = "direction, cipher or block size changed";
+    } else if (fstat(out_fd, &out_stat) == -1 ||
+               (uint64_t)out_stat.st_size != old->data_size ||
+               file_mtime_ns(&out_stat) != old->output_mtime) {
+        reason = "output was modified outside incremental runs";
+    } else {
+        manifest_keys(old, key, hash_key, check);
+        if (memcmp(check, old->key_check, sizeof(check)) != 0) {
+            reason = "key changed";
+        }
+    }
+    if (reason) {
+        printf("Note: Not using %s (%s), writing all blocks.\n", path, reason);
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = old->num_blocks * SHA256_DIGEST_LEN;
+    unsigned char *hashes = malloc(size ? size : 1);
+    if (!hashes || pread_full(fd, hashes, size, sizeof(*old)) == -1) {
+        fprintf(stderr, "Error: Cannot read %s\n", path);
+        free(hashes);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    return hashes;
+}
+
+// 출력을 고치기 전에 이전 매니페스트를 미완료로 표시
+static int manifest_mark_dirty(const char *path, ManifestHeader *old) {
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    old->flags |= MANIFEST_DIRTY;
+    if (fd == -1 || pwrite_full(fd, old, sizeof(*old), 0) == -1 ||
+        (durability_mode != DURABILITY_NONE && fdatasync(fd) == -1)) {
+        fprintf(stderr, "Error: Cannot update %s: %s\n", path, strerror(errno));
+        if (fd != -1) close(fd);
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+// 새 매니페스트 기록: 임시 파일에 쓰고 동기화한 뒤 rename으로 교체
+static int manifest_write(const char *path, const ManifestHeader *header,
+                          const unsigned char *hashes) {
+    char tmp_path[MAX_PATH_LEN + 32];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1 ||
+        pwrite_full(fd, header, sizeof(*header), 0) == -1 ||
+        pwrite_full(fd, hashes, header->num_blocks * SHA256_DIGEST_LEN,
+                    sizeof(*header)) == -1 ||
+        (durability_mode != DURABILITY_NONE && fdatasync(fd) == -1)) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", tmp_path, strerror(errno));
+        if (fd != -1) close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+    close(fd);
+
+    if (rename(tmp_path, path) == -1) {
+        perror("rename (manifest)");
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+// 작업 스레드: 커서에서 블록을 가져와 해시하고, 바뀐 블록만 변환해 출력에 기록
+static void* incremental_thread_func(void *arg) {
+    IncrementalArg *targ = (IncrementalArg*)arg;
+    IncrementalJob *job = targ->job;
+
+    affinity_apply(targ->thread_id);
+
+    unsigned char *buf = malloc(MANIFEST_BLOCK_SIZE);
+    if (!buf) {
+        perror("malloc");
+        atomic_fetch_add(&job->errors, 1);
+        return NULL;
+    }
+
+    int block;
+    while ((block = atomic_fetch_add(&job->next_block, 1)) < job->num_blocks) {
+        if (atomic_load(&job->errors)) {
+            break;
+        }
+
+        off_t offset = (off_t)block * MANIFEST_BLOCK_SIZE;
+        size_t len = job->data_size - offset < MANIFEST_BLOCK_SIZE ?
+                     job->data_size - offset : MANIFEST_BLOCK_SIZE;
+        if (pread_full(job->in_fd, buf, len, offset) == -1) {
+            fprintf(stderr, "Error: Cannot read block %d of input\n", block);
+            atomic_fetch_add(&job->errors, 1);
+            break;
+        }
+
+        unsigned char *digest = job->hashes + (size_t)block * SHA256_DIGEST_LEN;
+        Sha256 ctx = job->hash_base;
+        sha256_update(&ctx, buf, len);
+        sha256_final(&ctx, digest);
+
+        // 길이가 다른 블록(크기가 바뀐 파일의 끝)은 해시도 다르므로 따로 비교하지 않음
+        if (job->old_hashes && (uint64_t)block < job->old_blocks &&
+            memcmp(job->old_hashes + (size_t)block * SHA256_DIGEST_LEN, digest,
+                   SHA256_DIGEST_LEN) == 0) {
+            continue;
+        }
+
+        xor_transform(job->ks, buf, buf, len, offset);
+        if (pwrite_full(job->out_fd, buf, len, offset) == -1) {
+            fprintf(stderr, "Error: Cannot write block %d of output: %s\n",
+                    block, strerror(errno));
+            atomic_fetch_add(&job->errors, 1);
+            break;
+        }
+        atomic_fetch_add(&job->changed, 1);
+        atomic_fetch_add(&job->bytes_written, len);
+    }
+
+    free(buf);
+    return NULL;
+}
+
+// 증분 처리: 파일 하나 (원시 입력 → 원시 출력)
+int process_incremental(const char *input_file, const char *output_file,
+                        int num_threads, char mode, const char *key,
+                        const FileLayout *layout) {
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    printf("\n=== Crypto System (Incremental Mode) ===\n");
+    printf("Input file: %s\n", input_file);
+    printf("Output file: %s\n", output_file);
+    printf("Mode: %s\n", mode == 'e' ? "Encryption" : "Decryption");
+    printf("Threads: %d\n", num_threads);
+
+    size_t data_size = layout->data_size;
+    if (data_size == 0) {
+        fprintf(stderr, "Error: File is empty or invalid\n");
+        return -1;
+    }
+    printf("File size: %.2f MB\n\n", data_size / 1024.0 / 1024.0);
+
+    KeyStream ks;
+    if (keystream_init(&ks, key) == -1) {
+        return -1;
+    }
+
+    ManifestHeader run;
+    memset(&run, 0, sizeof(run));
+    memcpy(run.magic, MANIFEST_MAGIC, sizeof(run.magic));
+    run.version = MANIFEST_VERSION;
+    run.operation = mode;
+    run.cipher = cipher_id();
+    run.block_size = MANIFEST_BLOCK_SIZE;
+    run.data_size = data_size;
+    run.num_blocks = (data_size + MANIFEST_BLOCK_SIZE - 1) / MANIFEST_BLOCK_SIZE;
+
+    char manifest_path[MAX_PATH_LEN + 16];
+    snprintf(manifest_path, sizeof(manifest_path), "%s.manifest", output_file);
+
+    int in_fd = open(input_file, O_RDONLY | O_CLOEXEC);
+    if (in_fd == -1) {
+        perror("open");
+        return -1;
+    }
+    posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // 기존 출력이 있으면 매니페스트와 대조, 없으면 새로 만들고 모든 블록 기록
+    ManifestHeader old;
+    unsigned char *old_hashes = NULL;
+    int out_fd = open(output_file, O_RDWR | O_CLOEXEC);
+    if (out_fd != -1) {
+        old_hashes = manifest_load(manifest_path, out_fd, &run, key, &old);
+    } else {
+        out_fd = open(output_file, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (out_fd == -1) {
+            perror("open");
+            close(in_fd);
+            return -1;
+        }
+    }
+
+    // 이전 매니페스트를 이어 쓰면 같은 salt(같은 해시 키)로 해시해야 비교 가능
+    if (old_hashes) {
+        run.salt = old.salt;
+        if (manifest_mark_dirty(manifest_path, &old) == -1) {
+            free(old_hashes);
+            close(in_fd);
+            close(out_fd);
+            return -1;
+        }
+    } else if (getrandom(&run.salt, sizeof(run.salt), 0) != sizeof(run.salt)) {
+        perror("getrandom");
+        close(in_fd);
+        close(out_fd);
+        return -1;
+    }
+
+    unsigned char hash_key[SHA256_DIGEST_LEN];
+    unsigned char hash_block[64] = { 0 };
+    manifest_keys(&run, key, hash_key, run.key_check);
+    memcpy(hash_block, hash_key, sizeof(hash_key));
+
+    IncrementalJob job = {
+        .ks = &ks,
+        .in_fd = in_fd,
+        .out_fd = out_fd,
+        .data_size = data_size,
+        .num_blocks = run.num_blocks,
+        .old_hashes = old_hashes,
+        .old_blocks = old_hashes ? old.num_blocks : 0,
+        .hashes = calloc(run.num_blocks, SHA256_DIGEST_LEN),
+    };
+    atomic_init(&job.next_block, 0);
+    atomic_init(&job.changed, 0);
+    atomic_init(&job.bytes_written, 0);
+    atomic_init(&job.errors, 0);
+    // 해시 키를 블록 하나로 채워 두면 블록마다 키를 다시 흡수하지 않음
+    sha256_init(&job.hash_base);
+    sha256_update(&job.hash_base, hash_block, sizeof(hash_block));
+
+    // 출력 크기를 입력에 맞춤 (늘어난 부분은 이전 해시가 없으므로 새로 기록)
+    struct stat out_stat;
+    if (!job.hashes || fstat(out_fd, &out_stat) == -1 ||
+        ((size_t)out_stat.st_size != data_size && ftruncate(out_fd, data_size) == -1)) {
+        perror("Error: Cannot prepare output");
+        free(job.hashes);
+        free(old_hashes);
+        close(in_fd);
+        close(out_fd);
+        return -1;
+    }
+
+    if (num_threads > job.num_blocks) {
+        num_threads = job.num_blocks;
+    }
+    printf("=== Hashing %d blocks of %.2f MB across %d threads ===\n",
+           job.num_blocks, MANIFEST_BLOCK_SIZE / 1024.0 / 1024.0, num_threads);
+
+    pthread_t threads[MAX_WORKERS];
+    IncrementalArg args[MAX_WORKERS];
+    int started = 0;
+    for (int i = 0; i < num_threads; i++) {
+        args[i].thread_id = i;
+        args[i].job = &job;
+        int err = pthread_create(&threads[i], NULL, incremental_thread_func, &args[i]);
+        if (err != 0) {
+            fprintf(stderr, "pthread_create: %s (continuing with %d threads)\n",
+                    strerror(err), started);
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int errors = atomic_load(&job.errors);
+    if (started == 0) {
+        errors++;
+    }
+
+    // 출력이 디스크에 닿은 뒤에만 새 매니페스트로 교체 (실패하면 이전 매니페스트는 미완료로 남음)
+    if (errors == 0 && durability_mode != DURABILITY_NONE && fdatasync(out_fd) == -1) {
+        fprintf(stderr, "fdatasync '%s': %s\n", output_file, strerror(errno));
+        errors++;
+    }
+    if (errors == 0 && fstat(out_fd, &out_stat) == -1) {
+        perror("fstat");
+        errors++;
+    }
+    if (errors == 0) {
+        run.output_mtime = file_mtime_ns(&out_stat);
+        if (manifest_write(manifest_path, &run, job.hashes) == -1) {
+            errors++;
+        }
+    }
+
+    int changed = atomic_load(&job.changed);
+    double mb_written = atomic_load(&job.bytes_written) / (1024.0 * 1024.0);
+    free(job.hashes);
+    free(old_hashes);
+    close(in_fd);
+    close(out_fd);
+    if (errors != 0) {
+        return -1;
+    }
+
+    gettimeofday(&end, NULL);
+
+    printf("\n=== Processing Complete ===\n");
+    printf("Output file: %s\n", output_file);
+
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_usec - start.tv_usec) / 1000000.0;
+    double mb_size = data_size / (1024.0 * 1024.0);
+
+    printf("\n=== Performance Statistics ===\n");
+    printf("File size: %.2f MB\n", mb_size);
+    printf("Blocks rewritten: %d of %d (%.2f MB written)\n",
+           changed, job.num_blocks, mb_written);
+    printf("Processing time: %.3f seconds\n", elapsed);
+    printf("Throughput: %.2f MB/s (input hashed)\n", mb_size / elapsed);
+    printf("==============================\n");
+
+    return 0;
+}
@@ -13,19 +13,9 @@ SharedData* init_shared_memory(void) {
         return NULL;
     }
 
-    // 공유 데이터 초기화
-    shared->total_chunks = 0;
-    shared->completed_chunks = 0;
-    shared->shutdown_flag = 0;
-    memset(shared->worker_status, 0, sizeof(shared->worker_status));
-    memset(shared->worker_progress, 0, sizeof(shared->worker_progress));
-
-    // 프로세스 간 공유 뮤텍스 초기화 (교안 ch11 기반)
-    pthread_mutexattr_t attr;
-    pthread_mutexattr_init(&attr);
-    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
-    pthread_mutex_init(&shared->mutex, &attr);
-    pthread_mutexattr_destroy(&attr);
+    // 공유 데이터 초기화 (잠금 없이 원자적 카운터만 사용)
+    atomic_init(&shared->shutdown_flag, 0);
+    shared_reset(shared, 0, 0);
 
     return shared;
 }
@@ -33,11 +23,117 @@ SharedData* init_shared_memory(void) {
 // 공유 메모리 해제
 void cleanup_shared_memory(SharedData *shared) {
     if (shared) {
-        pthread_mutex_destroy(&shared->mutex);
         munmap(shared, sizeof(SharedData));
     }
 }
 
+// 새 작업 시작 전 카운터 초기화 (워커가 일하지 않는 동안 마스터만 호출)
+void shared_reset(SharedData *shared, int total_chunks, uint64_t total_bytes) {
+    shared->total_chunks = total_chunks;
+    shared->total_bytes = total_bytes;
+    for (int i = 0; i < MAX_WORKERS; i++) {
+        atomic_store_explicit(&shared->workers[i].bytes_done, 0, memory_order_relaxed);
+        atomic_store_explicit(&shared->workers[i].chunks_done, 0, memory_order_relaxed);
+        atomic_store_explicit(&shared->workers[i].status, STATUS_IDLE, memory_order_relaxed);
+    }
+    // 커서는 마지막에 release로 기록: 커서에서 청크를 가져간 워커는 초기화된 슬롯을 본다
+    atomic_store_explicit(&shared->next_chunk, 0, memory_order_release);
+}
+
+// 완료된 청크 수 (워커별 슬롯 합산)
+int shared_completed_chunks(SharedData *shared) {
+    int completed = 0;
+    for (int i = 0; i < MAX_WORKERS; i++) {
+        completed += atomic_load_explicit(&shared->workers[i].chunks_done,
+                                          memory_order_acquire);
+    }
+    return completed;
+}
+
+// 처리된 바이트 수 (워커별 슬롯 합산)
+uint64_t shared_bytes_done(SharedData *shared) {
+    uint64_t bytes = 0;
+    for (int i = 0; i < MAX_WORKERS; i++) {
+        bytes += atomic_load_explicit(&shared->workers[i].bytes_done,
+                                      memory_order_relaxed);
+    }
+    return bytes;
+}
+
+// --populate: 청크를 처리하기 전에 페이지 테이블을 한 번에 채움 (fork 전에 main에서 설정)
+int map_populate = 0;
+
+// 출력에 구멍을 남겨야 하는 실행 (빈 블록 지도가 있는 컨테이너, fork 전에 layout_prepare가 설정)
+// 쓰기 폴트가 2MB folio나 readahead 창 크기의 folio를 만들면 파일 시스템이 folio 전체를
+// 할당하므로, 이때 쓰기 매핑은 huge page와 readahead 없이 4KB 페이지 단위로만 채움
+int map_sparse = 0;
+
+// huge page로 매핑될 수 있도록 주소를 파일 오프셋과 같은 HUGE_PAGE_SIZE 위상에 맞춰 매핑
+// (주소와 오프셋이 함께 2MB 경계에 놓여야 대형 folio를 PMD로 매핑할 수 있음)
+// 여유를 둔 영역을 예약한 뒤 맞춘 위치에 MAP_FIXED로 매핑하고 남는 부분은 반환
+static void* map_aligned(int fd, off_t offset, size_t size, int prot) {
+    if (size < HUGE_PAGE_SIZE) {
+        return mmap(NULL, size, prot, MAP_SHARED, fd, offset);
+    }
+
+    size_t reserve_size = size + HUGE_PAGE_SIZE;
+    unsigned char *reserve = mmap(NULL, reserve_size, PROT_NONE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reserve == MAP_FAILED) {
+        return mmap(NULL, size, prot, MAP_SHARED, fd, offset);
+    }
+
+    uintptr_t skew = ((uintptr_t)offset - (uintptr_t)reserve) & (HUGE_PAGE_SIZE - 1);
+    unsigned char *aligned = reserve + skew;
+    void *addr = mmap(aligned, size, prot, MAP_SHARED | MAP_FIXED, fd, offset);
+    if (addr == MAP_FAILED) {
+        munmap(reserve, reserve_size);
+        return MAP_FAILED;
+    }
+
+    // 매핑 앞뒤로 남은 예약 영역 반환 (길이는 페이지 배수로 올림)
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    unsigned char *end = aligned + ((size + page_size - 1) & ~(page_size - 1));
+    if (aligned > reserve) {
+        munmap(reserve, aligned - reserve);
+    }
+    if (end < reserve + reserve_size) {
+        munmap(end, reserve + reserve_size - end);
+    }
+    return addr;
+}
+
+// 열린 파일의 [offset, offset + size) 범위 매핑 (offset은 페이지 크기 배수)
+// 워커는 자기 청크 범위만 이 함수로 매핑하고 처리가 끝나면 unmap_file로 해제
+void* map_file_range(int fd, off_t offset, size_t size, int writable) {
+    int prot = PROT_READ;
+    if (writable) prot |= PROT_WRITE;
+
+    if (writable && map_sparse) {
+        void *addr = mmap(NULL, size, prot, MAP_SHARED, fd, offset);
+        if (addr == MAP_FAILED) {
+            perror("mmap");
+            return NULL;
+        }
+        madvise(addr, size, MADV_RANDOM);
+        return addr;
+    }
+
+    void *addr = map_aligned(fd, offset, size, prot);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+
+    // 투명 huge page: 대형 folio를 지원하는 파일 시스템이면 2MB 단위로 매핑되어
+    // 4KB마다 생기던 페이지 폴트가 줄어듦 (지원하지 않으면 EINVAL, 무시)
+    if (size >= HUGE_PAGE_SIZE) {
+        madvise(addr, size, MADV_HUGEPAGE);
+    }
+
+    return addr;
+}
+
 // 파일을 메모리에 매핑 (교안 ch09 예제 9-1 기반)
 void* map_file_to_memory(const char *filename, size_t *file_size, int writable) {
     int flags = writable ? O_RDWR : O_RDONLY;
@@ -63,17 +159,12 @@ void* map_file_to_memory(const char *filename, size_t *file_size, int writable)
         return NULL;
     }
 
-    int prot = PROT_READ;
-    if (writable) prot |= PROT_WRITE;
+    // 청크 안에서는 순차 접근: 이 파일의 readahead 창을 키움
+    // (매핑이 같은 struct file을 참조하므로 fd를 닫아도 유지됨)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 
-    void *addr = mmap(NULL, *file_size, prot, MAP_SHARED, fd, 0);
+    void *addr = map_file_range(fd, 0, *file_size, writable);
     close(fd);  // 매핑 후 파일 디스크립터는 닫아도 됨
-
-    if (addr == MAP_FAILED) {
-        perror("mmap");
-        return NULL;
-    }
-
     return addr;
 }
 
@@ -133,3 +224,63 @@ void close_unused_pipes(int pipes_to[][2], int pipes_from[][2],
     close(pipes_to[current_worker_id][1]);      // 쓰기 끝 닫기 (읽기만 함)
     close(pipes_from[current_worker_id][0]);    // 읽기 끝 닫기 (쓰기만 함)
 }
+
+// 지정한 크기를 모두 읽을 때까지 반복 (파이프는 PIPE_BUF보다 큰 메시지를 나눠 전달할 수 있음)
+// 반환값: 읽은 바이트 수 (EOF면 그보다 작음), 에러 시 -1
+ssize_t read_full(int fd, void *buf, size_t len) {
+    size_t total = 0;
+
+    while (total < len) {
+        ssize_t n = read(fd, (char*)buf + total, len - total);
+        if (n == -1) {
+            if (errno == EINTR) continue;  // 시그널로 중단되었으면 재시도
+            return -1;
+        }
+        if (n == 0) break;  // EOF
+        total += n;
+    }
+
+    return total;
+}
+
+// 지정한 크기를 모두 쓸 때까지 반복
+int write_full(int fd, const void *buf, size_t len) {
+    size_t total = 0;
+
+    while (total < len) {
+        ssize_t n = write(fd, (const char*)buf + total, len - total);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        total += n;
+    }
+
+    return 0;
+}
+
+// 파일의 지정한 위치에서 len 바이트를 모두 읽음 (파일이 짧으면 -1)
+int pread_full(int fd, void *buf, size_t len, off_t offset) {
+    for (size_t done = 0; done < len; ) {
+        ssize_t n = pread(fd, (char*)buf + done, len - done, offset + done);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) {
+            return -1;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+// 파일의 지정한 위치에 len 바이트를 모두 씀
+int pwrite_full(int fd, const void *buf, size_t len, off_t offset) {
+    for (size_t done = 0; done < len; ) {
+        ssize_t n = pwrite(fd, (const char*)buf + done, len - done, offset + done);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) {
+            return -1;
+        }
+        done += n;
+    }
+    return 0;
+}
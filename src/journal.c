@@ -0,0 +1,361 @@
+#include "crypto_system.h"
+#include <sys/random.h>
+
+// 청크 진행 저널 (제자리 변환의 충돌 안전성 기록)
+//
+// <파일>.journal 에 헤더와 청크별 엔트리를 두고 MAP_SHARED로 매핑한다.
+// 워커는 작업을 받으면 같은 파일을 MAP_SHARED로 열어 자기 청크의 엔트리를 직접 갱신한다
+// (청크당 워커 1개 → 잠금 불필요).
+// 워커는 "데이터 블록 msync → 엔트리 갱신 → 저널 msync" 순서를 지키므로,
+// 중단되더라도 [start, start + done_bytes) 는 확실히 변환됨,
+// 그 다음 한 블록(JOURNAL_BLOCK_SIZE)은 부분 변환 가능, 나머지는 원본임이 보장된다.
+// 정상 종료 시 저널을 삭제하므로, 저널이 남아 있다는 것 자체가 중단 기록이다.
+//
+// 같은 형식을 출력 파일을 따로 만드는 실행의 진행 기록(<출력>.journal)으로도 쓴다.
+// 이때는 마스터가 완료 보고를 받을 때마다 청크를 CHUNK_DONE으로 기록하고(journal_chunk_done),
+// --resume은 기록을 검증한 뒤 완료되지 않은 청크만 다시 처리한다. 입력과 출력이 따로 있으므로
+// 청크를 처음부터 다시 변환해도 결과가 같아, 진행 중이던 청크의 위치는 기록하지 않는다.
+// 헤더에는 엔진, nonce, 입력 파일의 크기와 수정 시각, 키 확인 값을 남겨
+// 다른 입력이나 키로 이어서 처리해 출력이 섞이는 것을 막는다.
+
+// 저널 파일 경로 생성
+static void journal_path(const char *target, char *path, size_t len) {
+    snprintf(path, len, "%s.journal", target);
+}
+
+// 저널 존재 여부 확인
+int journal_exists(const char *target) {
+    char path[MAX_PATH_LEN];
+    journal_path(target, path, sizeof(path));
+    return access(path, F_OK) == 0;
+}
+
+// 새 저널 파일 생성 및 매핑 (엔트리는 ftruncate로 0 = CHUNK_PENDING)
+static int journal_map_new(Journal *journal, const char *target, int num_chunks) {
+    journal_path(target, journal->path, sizeof(journal->path));
+
+    journal->map_size = sizeof(JournalHeader) + num_chunks * sizeof(JournalEntry);
+
+    journal->fd = open(journal->path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (journal->fd == -1) {
+        perror("open journal");
+        return -1;
+    }
+
+    if (ftruncate(journal->fd, journal->map_size) == -1) {
+        perror("ftruncate journal");
+        close(journal->fd);
+        unlink(journal->path);
+        return -1;
+    }
+
+    void *addr = mmap(NULL, journal->map_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, journal->fd, 0);
+    if (addr == MAP_FAILED) {
+        perror("mmap journal");
+        close(journal->fd);
+        unlink(journal->path);
+        return -1;
+    }
+
+    journal->header = addr;
+    journal->entries = (JournalEntry*)((char*)addr + sizeof(JournalHeader));
+    return 0;
+}
+
+// 변환 시작 전에 저널 자체가 디스크에 있어야 함
+static int journal_sync_new(Journal *journal) {
+    if (msync(journal->header, journal->map_size, MS_SYNC) == -1 ||
+        fsync(journal->fd) == -1) {
+        perror("sync journal");
+        journal_close(journal);
+        unlink(journal->path);
+        return -1;
+    }
+    return 0;
+}
+
+// 저널 생성 및 매핑
+int journal_create(Journal *journal, const char *target, char operation,
+                   size_t file_size, size_t chunk_size, int num_chunks) {
+    if (journal_map_new(journal, target, num_chunks) == -1) {
+        return -1;
+    }
+
+    memcpy(journal->header->magic, JOURNAL_MAGIC, sizeof(journal->header->magic));
+    journal->header->version = JOURNAL_VERSION;
+    journal->header->operation = operation;
+    journal->header->file_size = file_size;
+    journal->header->chunk_size = chunk_size;
+    journal->header->num_chunks = num_chunks;
+
+    return journal_sync_new(journal);
+}
+
+// 키 확인 값: SHA-256(매직 || salt || 키)의 앞부분
+static void journal_key_check(const JournalHeader *header, const char *key,
+                              unsigned char out[JOURNAL_KEY_CHECK_LEN]) {
+    unsigned char digest[SHA256_DIGEST_LEN];
+    Sha256 ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, JOURNAL_MAGIC, sizeof(header->magic));
+    sha256_update(&ctx, &header->salt, sizeof(header->salt));
+    sha256_update(&ctx, key, strnlen(key, MAX_KEY_LEN));
+    sha256_final(&ctx, digest);
+    memcpy(out, digest, JOURNAL_KEY_CHECK_LEN);
+}
+
+// 입력 파일의 크기와 수정 시각
+static int journal_source(const char *source, uint64_t *size, int64_t *mtime) {
+    struct stat statbuf;
+    if (stat(source, &statbuf) == -1) {
+        perror("stat");
+        return -1;
+    }
+    *size = statbuf.st_size;
+    *mtime = (int64_t)statbuf.st_mtim.tv_sec * 1000000000 + statbuf.st_mtim.tv_nsec;
+    return 0;
+}
+
+// 진행 기록 시작 (run: operation, file_size, chunk_size, num_chunks, cipher, nonce)
+// 이전 실행이 남긴 기록은 이어서 처리하지 않는다는 뜻이므로 지우고 새로 만든다.
+int journal_begin(Journal *journal, const char *target, const JournalHeader *run,
+                  const char *source, const char *key) {
+    JournalHeader header = *run;
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    if (journal_source(source, &header.source_size, &header.source_mtime) == -1) {
+        return -1;
+    }
+    if (getrandom(&header.salt, sizeof(header.salt), 0) != sizeof(header.salt)) {
+        perror("getrandom");
+        return -1;
+    }
+    journal_key_check(&header, key, header.key_check);
+
+    if (journal_exists(target)) {
+        printf("Note: Discarding %s.journal from an interrupted run "
+               "(use --resume to continue it).\n", target);
+        char path[MAX_PATH_LEN];
+        journal_path(target, path, sizeof(path));
+        unlink(path);
+    }
+
+    if (journal_map_new(journal, target, header.num_chunks) == -1) {
+        return -1;
+    }
+    *journal->header = header;
+    return journal_sync_new(journal);
+}
+
+// 이전 실행의 진행 기록을 열어 이번 실행과 맞는지 확인
+// run->chunk_size가 0이면 기록의 청크 크기를 그대로 사용 (원시 파일)
+// 완료된 청크 수를 반환 (기록이 없거나 맞지 않으면 -1)
+int journal_resume(Journal *journal, const char *target, const JournalHeader *run,
+                   const char *source, const char *key) {
+    if (!journal_exists(target)) {
+        fprintf(stderr, "Error: No journal to resume (%s.journal not found)\n", target);
+        return -1;
+    }
+    if (journal_open(journal, target) == -1) {
+        return -1;
+    }
+
+    const JournalHeader *h = journal->header;
+    const char *reason = NULL;
+    unsigned char check[JOURNAL_KEY_CHECK_LEN];
+    uint64_t source_size;
+    int64_t source_mtime;
+    if (memcmp(h->magic, JOURNAL_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != JOURNAL_VERSION || h->chunk_size == 0 ||
+        journal->map_size < sizeof(JournalHeader) +
+                            (size_t)h->num_chunks * sizeof(JournalEntry) ||
+        h->num_chunks != (h->file_size + h->chunk_size - 1) / h->chunk_size) {
+        reason = "journal is damaged or from another version";
+    } else if (h->operation != run->operation) {
+        reason = "journal is for the other direction (-e / -d)";
+    } else if (h->file_size != run->file_size ||
+               (run->chunk_size != 0 && h->chunk_size != run->chunk_size)) {
+        reason = "data size or chunk layout differs";
+    } else if (h->cipher != run->cipher || h->nonce != run->nonce) {
+        reason = "cipher differs";
+    } else if (journal_source(source, &source_size, &source_mtime) == -1 ||
+               h->source_size != source_size || h->source_mtime != source_mtime) {
+        reason = "input file changed since the interrupted run";
+    } else {
+        journal_key_check(h, key, check);
+        if (memcmp(check, h->key_check, sizeof(check)) != 0) {
+            reason = "wrong key";
+        }
+    }
+    if (reason) {
+        fprintf(stderr, "Error: Cannot resume from %s: %s\n", journal->path, reason);
+        journal_close(journal);
+        return -1;
+    }
+
+    return journal_chunks_done(journal);
+}
+
+// 기존 저널 매핑 (워커가 작업을 받을 때 사용)
+int journal_open(Journal *journal, const char *target) {
+    journal_path(target, journal->path, sizeof(journal->path));
+
+    journal->fd = open(journal->path, O_RDWR);
+    if (journal->fd == -1) {
+        perror("open journal");
+        return -1;
+    }
+
+    struct stat statbuf;
+    if (fstat(journal->fd, &statbuf) == -1 ||
+        (size_t)statbuf.st_size < sizeof(JournalHeader)) {
+        fprintf(stderr, "Error: Invalid journal '%s'\n", journal->path);
+        close(journal->fd);
+        journal->fd = -1;
+        return -1;
+    }
+
+    journal->map_size = statbuf.st_size;
+    void *addr = mmap(NULL, journal->map_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, journal->fd, 0);
+    if (addr == MAP_FAILED) {
+        perror("mmap journal");
+        close(journal->fd);
+        journal->fd = -1;
+        return -1;
+    }
+
+    journal->header = addr;
+    journal->entries = (JournalEntry*)((char*)addr + sizeof(JournalHeader));
+    return 0;
+}
+
+// 청크 엔트리 갱신 후 디스크에 동기화
+void journal_update(Journal *journal, int chunk_id, uint64_t done_bytes, int state) {
+    if (!journal || !journal->header) {
+        return;
+    }
+
+    journal->entries[chunk_id].done_bytes = done_bytes;
+    journal->entries[chunk_id].state = state;
+
+    // 엔트리가 있는 페이지만 동기화
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t entry_offset = (char*)&journal->entries[chunk_id] - (char*)journal->header;
+    size_t page_start = entry_offset & ~(page_size - 1);
+    if (msync((char*)journal->header + page_start,
+              entry_offset + sizeof(JournalEntry) - page_start, MS_SYNC) == -1) {
+        perror("msync journal");
+    }
+}
+
+// 진행 기록: 청크 완료 (마스터가 보고를 받을 때, 스레드 엔진은 작업 스레드가)
+// sync: 청크 데이터가 이미 디스크에 있을 때만 기록도 동기화 (--durability chunk)
+// 그 외 정책에서는 프로세스 중단에는 안전하지만 전원 손실 후에는 기록을 믿을 수 없다.
+void journal_chunk_done(Journal *journal, int chunk_id, uint64_t size,
+                        uint32_t checksum, int sync) {
+    if (!journal || !journal->header ||
+        chunk_id < 0 || (uint32_t)chunk_id >= journal->header->num_chunks) {
+        return;
+    }
+    journal->entries[chunk_id].checksum = checksum;
+    if (sync) {
+        journal_update(journal, chunk_id, size, CHUNK_DONE);
+    } else {
+        journal->entries[chunk_id].done_bytes = size;
+        journal->entries[chunk_id].state = CHUNK_DONE;
+    }
+}
+
+// 이전 실행에서 완료된 청크인지 (--resume에서 건너뛸 청크)
+int journal_chunk_is_done(const Journal *journal, int chunk_id) {
+    return journal && journal->header &&
+           chunk_id >= 0 && (uint32_t)chunk_id < journal->header->num_chunks &&
+           journal->entries[chunk_id].state == CHUNK_DONE;
+}
+
+// 완료로 기록된 청크 수
+int journal_chunks_done(const Journal *journal) {
+    int done = 0;
+    for (uint32_t i = 0; journal->header && i < journal->header->num_chunks; i++) {
+        done += journal->entries[i].state == CHUNK_DONE;
+    }
+    return done;
+}
+
+// 저널 매핑 해제
+void journal_close(Journal *journal) {
+    if (journal->header) {
+        munmap(journal->header, journal->map_size);
+        journal->header = NULL;
+        journal->entries = NULL;
+    }
+    if (journal->fd != -1) {
+        close(journal->fd);
+        journal->fd = -1;
+    }
+}
+
+// 정상 완료: 저널 삭제
+void journal_remove(Journal *journal) {
+    journal_close(journal);
+    if (unlink(journal->path) == -1) {
+        perror("unlink journal");
+    }
+}
+
+// 남아 있는 저널 내용 출력 (중단된 제자리 변환 보고)
+void journal_print_report(const char *target) {
+    char path[MAX_PATH_LEN];
+    journal_path(target, path, sizeof(path));
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("open journal");
+        return;
+    }
+
+    JournalHeader header;
+    if (read(fd, &header, sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0) {
+        fprintf(stderr, "Error: '%s' is not a valid journal\n", path);
+        close(fd);
+        return;
+    }
+
+    printf("=== Interrupted in-place run: %s ===\n", target);
+    printf("Operation: %s\n", header.operation == 'e' ? "Encryption" : "Decryption");
+    printf("File size: %lu bytes, %u chunks of %lu bytes\n",
+           (unsigned long)header.file_size, header.num_chunks,
+           (unsigned long)header.chunk_size);
+
+    for (uint32_t i = 0; i < header.num_chunks; i++) {
+        JournalEntry entry;
+        if (read(fd, &entry, sizeof(entry)) != sizeof(entry)) {
+            fprintf(stderr, "Error: Journal truncated at chunk %u\n", i);
+            break;
+        }
+
+        uint64_t start = i * header.chunk_size;
+        uint64_t size = (i == header.num_chunks - 1) ?
+                        header.file_size - start : header.chunk_size;
+
+        if (entry.state == CHUNK_DONE) {
+            printf("  chunk %u [%lu, %lu): done\n", i,
+                   (unsigned long)start, (unsigned long)(start + size));
+        } else if (entry.state == CHUNK_ACTIVE) {
+            uint64_t unsure_end = entry.done_bytes + JOURNAL_BLOCK_SIZE;
+            if (unsure_end > size) unsure_end = size;
+            printf("  chunk %u [%lu, %lu): done, [%lu, %lu): possibly partial, rest untouched\n",
+                   i, (unsigned long)start, (unsigned long)(start + entry.done_bytes),
+                   (unsigned long)(start + entry.done_bytes),
+                   (unsigned long)(start + unsure_end));
+        } else {
+            printf("  chunk %u [%lu, %lu): untouched\n", i,
+                   (unsigned long)start, (unsigned long)(start + size));
+        }
+    }
+
+    close(fd);
+}
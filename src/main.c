@@ -11,39 +11,223 @@ SharedData *shared_data = NULL;
 void print_usage(const char *program_name) {
     printf("Usage: %s [OPTIONS]\n", program_name);
     printf("\nOptions:\n");
-    printf("  -e <file>    Encrypt file\n");
-    printf("  -d <file>    Decrypt file\n");
+    printf("  -e <file>    Encrypt file (- reads stdin and streams to stdout or -o)\n");
+    printf("  -d <file>    Decrypt file (- reads stdin and streams to stdout or -o)\n");
     printf("  -o <file>    Output file (default: <input>.encrypted or <input>.decrypted)\n");
     printf("  -k <key>     Encryption key (required)\n");
-    printf("  -w <num>     Number of worker processes (default: 4, range: 1-%d)\n", MAX_WORKERS);
-    printf("  -D <dir>     Process entire directory\n");
+    printf("  -w <num>     Number of worker processes or threads (default: 4, range: 1-%d)\n", MAX_WORKERS);
+    printf("  -c <size>    Chunk size for dynamic scheduling, e.g. 4M or 2M (minimum 1M)\n");
+    printf("               (default: auto, %d-%d MB)\n",
+           CHUNK_MIN_SIZE / 1024 / 1024, DEFAULT_CHUNK_SIZE / 1024 / 1024);
+    printf("  -T           Use thread engine (pthread pool, one shared mapping)\n");
+    printf("               instead of worker processes\n");
+    printf("  -U           Use io_uring I/O backend in worker processes\n");
+    printf("               (falls back to mmap if the kernel lacks io_uring)\n");
+    printf("  -O           Direct I/O (O_DIRECT, aligned buffer pool) - bypasses page cache\n");
+    printf("               for files larger than memory\n");
+    printf("  --cipher <xor|chacha20>\n");
+    printf("               Cipher engine (default: xor). chacha20 derives a 256-bit key\n");
+    printf("               from the password with SHA-256\n");
+    printf("  --container  Encrypt into a chunked container (header, chunks, index) that\n");
+    printf("               records cipher, nonce, sizes and a key check. Decryption\n");
+    printf("               detects containers automatically\n");
+    printf("  --range <offset[:length]>\n");
+    printf("               With -d: decrypt only this byte range of the original data\n");
+    printf("               (e.g. 1G:4K) to stdout or -o, reading only those pages\n");
+    printf("  --resume     Continue an interrupted run: completed chunks are recorded in\n");
+    printf("               <output>.journal, only the missing ones are processed\n");
+    printf("  --incremental\n");
+    printf("               Re-encrypt into an existing output, rewriting only the 1 MB\n");
+    printf("               blocks whose hash changed since the last run (<output>.manifest)\n");
+    printf("  --durability <none|fdatasync|writebehind|chunk>\n");
+    printf("               When output reaches disk (default: chunk)\n");
+    printf("                 chunk       sync each chunk before reporting it done\n");
+    printf("                 fdatasync   one fdatasync per output file at the end\n");
+    printf("                 writebehind start writeback while processing, fdatasync at end\n");
+    printf("                 none        leave it to the kernel (no crash guarantee)\n");
+    printf("  --affinity <numa|cpulist>\n");
+    printf("               Pin workers to CPUs: round-robin over NUMA nodes, or\n");
+    printf("               worker i on the i-th CPU of a list such as 0-3,8-11\n");
+    printf("  --populate   Prefault each chunk's page tables before processing\n");
+    printf("               (MAP_POPULATE per chunk via MADV_POPULATE_READ/WRITE)\n");
+    printf("  -i           In-place mode (transform input file directly, no output file)\n");
+    printf("  -D <dir>     Process all files in a directory concurrently (with -e or -d)\n");
     printf("  -v           Verbose mode (show system info)\n");
     printf("  -h           Show this help message\n");
     printf("\nExamples:\n");
     printf("  %s -e input.dat -k \"mypassword\"                    # Single process encryption\n", program_name);
     printf("  %s -e input.dat -o output.dat -k \"pass\" -w 4       # 4 workers encryption\n", program_name);
     printf("  %s -d encrypted.dat -k \"mypassword\"                # Decryption\n", program_name);
+    printf("  %s -e input.dat -k \"pass\" -i                       # In-place encryption\n", program_name);
     printf("  %s -D /path/to/dir -k \"pass\" -e                    # Encrypt directory\n", program_name);
+    printf("  tar cf - dir | %s -e - -k \"pass\" > dir.tar.enc     # Encrypt a stream\n", program_name);
+}
+
+// 크기 문자열 파싱 ("8M", "512K", "1G", 접미사 없으면 바이트)
+static size_t parse_size(const char *str) {
+    char *end;
+    unsigned long long value = strtoull(str, &end, 10);
+
+    switch (*end) {
+        case 'k': case 'K': value *= 1024ULL; break;
+        case 'm': case 'M': value *= 1024ULL * 1024; break;
+        case 'g': case 'G': value *= 1024ULL * 1024 * 1024; break;
+        case '\0': break;
+        default: return 0;
+    }
+
+    return value;
+}
+
+// 범위 파싱 ("OFFSET:LENGTH" 또는 "OFFSET", 값은 parse_size 형식, 길이를 생략하면 끝까지)
+static int parse_range(const char *spec, uint64_t *offset, uint64_t *length) {
+    char start[64];
+    const char *colon = strchr(spec, ':');
+    size_t n = colon ? (size_t)(colon - spec) : strlen(spec);
+    if (n == 0 || n >= sizeof(start)) {
+        return -1;
+    }
+    memcpy(start, spec, n);
+    start[n] = '\0';
+
+    *offset = parse_size(start);
+    if (*offset == 0 && strspn(start, "0") != n) {
+        return -1;
+    }
+    *length = 0;
+    if (colon && (*length = parse_size(colon + 1)) == 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// 단일 프로세스 변환: 입력과 출력을 매핑해 한 번에 변환
+static int transform_file_mapped(const char *input_file, const char *output_file,
+                                 char mode, const KeyStream *ks,
+                                 const FileLayout *layout, int in_place) {
+    size_t file_size = layout->data_size;
+
+    // 입력과 출력을 각각 메모리에 매핑 (제자리 모드는 입력만 쓰기 가능으로)
+    printf("Mapping files to memory...\n");
+    size_t src_size, dst_size;
+    unsigned char *src_data = map_file_to_memory(input_file, &src_size, in_place);
+    if (!src_data) {
+        fprintf(stderr, "Error: Failed to map input file to memory\n");
+        return -1;
+    }
+
+    unsigned char *dst_data = src_data;
+    dst_size = src_size;
+    if (!in_place) {
+        dst_data = map_file_to_memory(output_file, &dst_size, 1);
+        if (!dst_data) {
+            fprintf(stderr, "Error: Failed to map output file to memory\n");
+            unmap_file(src_data, src_size);
+            return -1;
+        }
+    }
+
+    // 제자리 모드: 변환 전에 저널 생성 (중단 시 기록으로 남음)
+    Journal journal = { .fd = -1 };
+    if (in_place && journal_create(&journal, input_file, mode,
+                                   file_size, file_size, 1) == -1) {
+        unmap_file(src_data, src_size);
+        return -1;
+    }
+
+    // 암호화/복호화 수행 (입력 -> 출력 한 번에 변환, 컨테이너는 헤더 뒤 데이터만)
+    // 청크 단위로 나눠 청크마다 보고 (체크섬, 진행 기록), 제자리 모드는 파일 전체가 한 청크
+    printf("Processing...\n");
+    int sync_fd = in_place ? -1 : durability_open(output_file);
+    size_t step = layout->chunk_size ? layout->chunk_size : file_size;
+    int result = 0;
+    for (int id = 0; result == 0 && (size_t)id * step < file_size; id++) {
+        if (!layout_chunk_pending(layout, id)) {
+            continue;
+        }
+        off_t offset = (off_t)id * step;
+        size_t size = file_size - offset < step ? file_size - offset : step;
+        ChunkChecksum checksum;
+        chunk_checksum_init(&checksum, layout->checksum, id);
+        result = transform_chunk(ks, src_data + layout->in_data,
+                                 dst_data + layout->out_data, file_size,
+                                 offset, size, id,
+                                 in_place ? &journal : NULL, sync_fd, layout->out_data,
+                                 checksum.side != CHECKSUM_NONE ? &checksum : NULL,
+                                 NULL, 0);
+        if (result == 0) {
+            result = layout_chunk_done(layout, id, checksum.value);
+        }
+    }
+    if (sync_fd != -1) close(sync_fd);
+
+    // 메모리 매핑 해제
+    unmap_file(src_data, src_size);
+    if (!in_place) unmap_file(dst_data, dst_size);
+
+    if (result == -1) {
+        if (in_place) journal_close(&journal);
+        return -1;
+    }
+
+    // 모든 블록이 디스크에 기록되었으므로 저널 삭제
+    if (in_place) journal_remove(&journal);
+    return 0;
+}
+
+// 단일 프로세스 변환: direct I/O 버퍼 하나로 블록 단위 변환 (페이지 캐시 우회)
+static int transform_file_direct(const char *input_file, const char *output_file,
+                                 const KeyStream *ks, const FileLayout *layout) {
+    DirectFiles files;
+    DirectPool *pool = direct_pool_create(1);
+    if (!pool || direct_open(&files, input_file, output_file) == -1) {
+        direct_pool_destroy(pool);
+        return -1;
+    }
+    files.in_data = layout->in_data;
+    files.out_data = layout->out_data;
+
+    printf("Processing (direct I/O)...\n");
+    size_t file_size = layout->data_size;
+    size_t step = layout->chunk_size ? layout->chunk_size : file_size;
+    int result = 0;
+    for (int id = 0; result == 0 && (size_t)id * step < file_size; id++) {
+        if (!layout_chunk_pending(layout, id)) {
+            continue;
+        }
+        off_t offset = (off_t)id * step;
+        size_t size = file_size - offset < step ? file_size - offset : step;
+        ChunkChecksum checksum;
+        chunk_checksum_init(&checksum, layout->checksum, id);
+        result = direct_transform_chunk(pool, ks, &files, file_size, offset, size,
+                                        checksum.side != CHECKSUM_NONE ? &checksum : NULL,
+                                        NULL, 0);
+        if (result == 0) {
+            result = layout_chunk_done(layout, id, checksum.value);
+        }
+    }
+
+    direct_close(&files);
+    direct_pool_destroy(pool);
+    return result;
 }
 
 // 단일 프로세스 파일 처리 (1단계: 기본 구현)
 int process_single_file_simple(const char *input_file, const char *output_file,
-                                char mode, const char *key) {
+                                char mode, const char *key, int in_place,
+                                const FileLayout *layout) {
     struct timeval start, end;
     gettimeofday(&start, NULL);
 
     printf("\n=== Crypto System (Single Process Mode) ===\n");
     printf("Input file: %s\n", input_file);
     printf("Output file: %s\n", output_file);
-    printf("Mode: %s\n", mode == 'e' ? "Encryption" : "Decryption");
+    printf("Mode: %s%s\n", mode == 'e' ? "Encryption" : "Decryption",
+           in_place ? " (in-place)" : "");
     printf("Process ID: %d\n", getpid());
 
-    // 파일 검증
-    if (validate_file(input_file) == -1) {
-        return -1;
-    }
-
-    size_t file_size = get_file_size(input_file);
+    // 데이터 크기 (파일 검증은 layout_prepare에서 완료, 컨테이너는 헤더의 원본 크기)
+    size_t file_size = layout->data_size;
     if (file_size == 0) {
         fprintf(stderr, "Error: File is empty or invalid\n");
         return -1;
@@ -51,41 +235,27 @@ int process_single_file_simple(const char *input_file, const char *output_file,
 
     printf("File size: %.2f MB\n", file_size / 1024.0 / 1024.0);
 
-    // 파일 복사 (입력 -> 출력)
-    printf("\nCopying file...\n");
-    if (copy_file_direct(input_file, output_file) == -1) {
-        fprintf(stderr, "Error: Failed to copy file\n");
+    // 키스트림 준비
+    KeyStream ks;
+    if (keystream_init(&ks, key) == -1) {
         return -1;
     }
 
-    // 출력 파일을 메모리에 매핑
-    printf("Mapping file to memory...\n");
-    size_t mapped_size;
-    void *mapped_data = map_file_to_memory(output_file, &mapped_size, 1);
-    if (!mapped_data) {
-        fprintf(stderr, "Error: Failed to map file to memory\n");
+    // 출력 파일 생성 (복사 없이 크기만 확보, 제자리 모드는 생략)
+    if (!in_place && layout_create_output(layout, output_file) == -1) {
+        fprintf(stderr, "Error: Failed to create output file\n");
         return -1;
     }
 
-    // 암호화/복호화 수행
-    printf("Processing...\n");
-    if (mode == 'e') {
-        xor_encrypt((unsigned char*)mapped_data, mapped_size, key);
-    } else {
-        xor_decrypt((unsigned char*)mapped_data, mapped_size, key);
-    }
-
-    // 메모리 동기화 (디스크에 기록)
-    printf("Syncing to disk...\n");
-    if (msync(mapped_data, mapped_size, MS_SYNC) == -1) {
-        perror("msync");
-        unmap_file(mapped_data, mapped_size);
+    int result = use_direct_io && !in_place ?
+                 transform_file_direct(input_file, output_file, &ks, layout) :
+                 transform_file_mapped(input_file, output_file, mode, &ks,
+                                       layout, in_place);
+    if (result == -1 || layout_finish(layout, output_file) == -1 ||
+        durability_finish(output_file) == -1) {
         return -1;
     }
 
-    // 메모리 매핑 해제
-    unmap_file(mapped_data, mapped_size);
-
     gettimeofday(&end, NULL);
 
     printf("\n=== Processing Complete ===\n");
@@ -101,30 +271,175 @@ int process_single_file_simple(const char *input_file, const char *output_file,
     printf("File size: %.2f MB\n", mb_size);
     printf("Processing time: %.3f seconds\n", elapsed);
     printf("Throughput: %.2f MB/s\n", throughput);
+    print_fault_stats(file_size);
     printf("==============================\n");
 
     return 0;
 }
 
+// 워커 풀에서 파일 하나 처리 (워커는 이미 생성되어 있음)
+// 파일을 작은 청크로 나누고, 모든 워커가 공유 커서에서 청크를 가져가며 처리 (동적 스케줄링)
+static int run_file_on_pool(const char *input_file, const char *output_file,
+                            const FileLayout *layout, int num_workers, char mode,
+                            const char *key, int in_place, size_t chunk_size) {
+    size_t file_size = layout->data_size;
+
+    // 출력 파일 생성 (워커들이 입력에서 읽어 직접 기록, 제자리 모드는 생략)
+    if (!in_place) {
+        printf("Creating output file...\n");
+        if (layout_create_output(layout, output_file) == -1) {
+            fprintf(stderr, "Error: Failed to create output file\n");
+            return -1;
+        }
+    }
+
+    // 청크 계산 (컨테이너와 진행 기록은 정해 둔 청크 크기를 그대로 사용)
+    chunk_size = choose_chunk_size(file_size, num_workers,
+                                   layout->chunk_size ? layout->chunk_size : chunk_size);
+    int num_chunks = (file_size + chunk_size - 1) / chunk_size;
+
+    // 재개: 이전 실행에서 완료된 청크는 워커가 건너뛰므로 진행률은 남은 양 기준
+    shared_reset(shared_data, num_chunks - layout->resumed_chunks,
+                 file_size - layout->resumed_bytes);
+
+    // 제자리 모드: 작업 전달 전에 저널 생성 (워커들이 열어서 직접 갱신)
+    Journal journal = { .fd = -1 };
+    if (in_place && journal_create(&journal, input_file, mode, file_size,
+                                   chunk_size, num_chunks) == -1) {
+        return -1;
+    }
+
+    // 작업 할당: 모든 워커에게 같은 작업을 알리고, 청크는 워커들이 직접 가져감
+    printf("=== Scheduling %d chunks of %.2f MB across %d workers ===\n",
+           num_chunks, chunk_size / 1024.0 / 1024.0, num_workers);
+    WorkTask task;
+    memset(&task, 0, sizeof(task));
+    task.type = TASK_JOB;
+    task.file_size = file_size;
+    task.chunk_size = chunk_size;
+    task.num_chunks = num_chunks;
+    task.operation = mode;
+    task.in_place = in_place;
+    task.in_data = layout->in_data;
+    task.out_data = layout->out_data;
+    task.checksum = layout->checksum;
+    task.resume = layout->resume;
+    strncpy(task.key, key, sizeof(task.key) - 1);
+    strncpy(task.input_file, input_file, sizeof(task.input_file) - 1);
+    strncpy(task.output_file, output_file, sizeof(task.output_file) - 1);
+
+    int assigned = 0;
+    for (int i = 0; i < num_workers; i++) {
+        if (pool_submit(i, &task) == -1) {
+            break;
+        }
+        assigned++;
+    }
+    printf("\n");
+
+    // 워커들로부터 진행 상황 수신 (각 워커가 STATUS_IDLE을 보낼 때까지)
+    // 보고는 워커 순서가 아니라 도착 순서대로 처리
+    printf("=== Collecting results ===\n");
+    int done = 0;
+    int errors = 0;
+    int chunks_by_worker[MAX_WORKERS] = { 0 };
+    int busy[MAX_WORKERS] = { 0 };
+    for (int i = 0; i < assigned; i++) {
+        busy[i] = 1;
+    }
+
+    int active = assigned;
+    int interrupted = 0;
+    while (active > 0) {
+        PoolEvent event;
+        if (pool_wait(&event) == -1) {
+            errors++;
+            break;
+        }
+
+        int w = event.worker_id;
+        if (event.type == POOL_EVENT_INTERRUPT) {
+            // 워커들은 진행 중인 청크를 마친 뒤 커서에서 더 가져가지 않고 IDLE 보고
+            if (interrupted++) {
+                break;  // 두 번째 중단 요청: 기다리지 않음
+            }
+            printf("\n[Master] Received signal %d, stopping after current chunks...\n",
+                   event.status);
+            atomic_store(&shared_data->shutdown_flag, 1);
+            errors++;
+        } else if (event.type == POOL_EVENT_EXIT) {
+            if (busy[w]) {
+                fprintf(stderr, "[Master] Lost connection to worker %d\n", w);
+                busy[w] = 0;
+                active--;
+                errors++;
+            }
+        } else if (event.report.status == STATUS_IDLE) {
+            busy[w] = 0;
+            active--;
+        } else if (event.report.status == STATUS_DONE) {
+            done++;
+            chunks_by_worker[w]++;
+            if (layout_chunk_done(layout, event.report.chunk_id,
+                                  event.report.checksum) == -1) {
+                errors++;
+            }
+        } else {
+            fprintf(stderr, "[Master] Worker %d reported error on chunk %d\n",
+                    event.report.worker_pid, event.report.chunk_id);
+            errors++;
+        }
+    }
+
+    for (int i = 0; i < assigned; i++) {
+        printf("[Master] Worker %d (PID %d) completed %d chunks\n",
+               i, worker_pids[i], chunks_by_worker[i]);
+    }
+
+    done += layout->resumed_chunks;
+    if (done != num_chunks && errors == 0) {
+        fprintf(stderr, "Error: Only %d of %d chunks completed\n", done, num_chunks);
+        errors++;
+    }
+
+    // 컨테이너 인덱스 기록, fdatasync / writebehind 정책: 완료를 알리기 전에 출력 전체 동기화
+    if (errors == 0 && (layout_finish(layout, output_file) == -1 ||
+                        durability_finish(output_file) == -1)) {
+        errors++;
+    }
+
+    // 제자리 모드: 모든 청크가 완료된 경우에만 저널 삭제 (실패 시 기록 유지)
+    if (in_place) {
+        if (errors == 0) {
+            journal_remove(&journal);
+        } else {
+            journal_close(&journal);
+            fprintf(stderr, "Error: In-place run incomplete, see %s.journal\n",
+                    input_file);
+        }
+    }
+
+    return errors == 0 ? 0 : -1;
+}
+
 // 멀티프로세스 파일 처리 (2단계: 병렬 처리)
 int process_single_file_multiprocess(const char *input_file, const char *output_file,
-                                      int num_workers, char mode, const char *key) {
+                                      int num_workers, char mode, const char *key,
+                                      int in_place, size_t chunk_size,
+                                      const FileLayout *layout) {
     struct timeval start, end;
     gettimeofday(&start, NULL);
 
     printf("\n=== Crypto System (Multi-Process Mode) ===\n");
     printf("Input file: %s\n", input_file);
     printf("Output file: %s\n", output_file);
-    printf("Mode: %s\n", mode == 'e' ? "Encryption" : "Decryption");
+    printf("Mode: %s%s\n", mode == 'e' ? "Encryption" : "Decryption",
+           in_place ? " (in-place)" : "");
     printf("Master PID: %d\n", getpid());
     printf("Workers: %d\n", num_workers);
 
-    // 파일 검증
-    if (validate_file(input_file) == -1) {
-        return -1;
-    }
-
-    size_t file_size = get_file_size(input_file);
+    // 데이터 크기 (파일 검증은 layout_prepare에서 완료, 컨테이너는 헤더의 원본 크기)
+    size_t file_size = layout->data_size;
     if (file_size == 0) {
         fprintf(stderr, "Error: File is empty or invalid\n");
         return -1;
@@ -132,148 +447,44 @@ int process_single_file_multiprocess(const char *input_file, const char *output_
 
     printf("File size: %.2f MB\n\n", file_size / 1024.0 / 1024.0);
 
-    // 파일 복사
-    printf("Copying file...\n");
-    if (copy_file_direct(input_file, output_file) == -1) {
-        fprintf(stderr, "Error: Failed to copy file\n");
-        return -1;
-    }
-
-    // 공유 메모리 초기화
-    shared_data = init_shared_memory();
-    if (!shared_data) {
-        return -1;
-    }
-
-    // 청크 계산
-    size_t chunk_size = file_size / num_workers;
-    if (chunk_size < CHUNK_MIN_SIZE && file_size > CHUNK_MIN_SIZE) {
+    // 청크가 CHUNK_MIN_SIZE보다 작아지면 워커 수를 줄임
+    if (file_size / num_workers < CHUNK_MIN_SIZE && file_size > CHUNK_MIN_SIZE) {
         num_workers = file_size / CHUNK_MIN_SIZE;
         if (num_workers == 0) num_workers = 1;
-        chunk_size = file_size / num_workers;
         printf("Adjusted workers to %d (chunk size: %.2f MB)\n",
-               num_workers, chunk_size / 1024.0 / 1024.0);
+               num_workers, file_size / num_workers / 1024.0 / 1024.0);
     }
 
-    shared_data->total_chunks = num_workers;
-
-    // 파이프 생성 (교안 ch10 기반)
-    printf("Creating pipes...\n");
-    if (create_pipes(pipes_to_workers, pipes_from_workers, num_workers) == -1) {
-        cleanup_shared_memory(shared_data);
+    // 공유 메모리 초기화
+    shared_data = init_shared_memory();
+    if (!shared_data) {
         return -1;
     }
 
     // 시그널 핸들러 설정
     setup_signal_handlers();
 
-    // 워커 프로세스 생성 (교안 ch07 예제 7-2 기반)
-    printf("Creating %d worker processes...\n", num_workers);
-    for (int i = 0; i < num_workers; i++) {
-        pid_t pid = fork();
-
-        if (pid == -1) {
-            perror("fork");
-            // 이미 생성된 워커들 정리
-            for (int j = 0; j < i; j++) {
-                kill(worker_pids[j], SIGTERM);
-                waitpid(worker_pids[j], NULL, 0);
-            }
-            cleanup_shared_memory(shared_data);
-            return -1;
-        }
-
-        if (pid == 0) {  // 자식 프로세스 (워커)
-            // 사용하지 않는 파이프 닫기
-            close_unused_pipes(pipes_to_workers, pipes_from_workers,
-                               num_workers, i);
-
-            worker_main(i, pipes_to_workers[i][0], pipes_from_workers[i][1],
-                       shared_data, output_file);
-            exit(0);  // worker_main에서 exit하지만 명시적으로 추가
-        }
-
-        // 부모 프로세스
-        worker_pids[i] = pid;
-        close(pipes_to_workers[i][0]);      // 읽기 끝 닫기
-        close(pipes_from_workers[i][1]);    // 쓰기 끝 닫기
-    }
-
-    printf("[Master] All workers created\n\n");
-
-    // 작업 할당
-    printf("=== Assigning tasks to workers ===\n");
-    for (int i = 0; i < num_workers; i++) {
-        WorkTask task;
-        task.chunk_id = i;
-        task.offset = i * chunk_size;
-        task.size = (i == num_workers - 1) ?
-                    (file_size - task.offset) : chunk_size;
-        task.operation = mode;
-        strncpy(task.key, key, sizeof(task.key) - 1);
-        task.key[sizeof(task.key) - 1] = '\0';
-
-        write(pipes_to_workers[i][1], &task, sizeof(WorkTask));
-        printf("[Master] Worker %d (PID %d): chunk %d (offset=%ld, size=%zu)\n",
-               i, worker_pids[i], i, task.offset, task.size);
-    }
-    printf("\n");
-
-    // 워커들로부터 진행 상황 수신
-    printf("=== Collecting results ===\n");
-    int completed = 0;
-    while (completed < num_workers) {
-        for (int i = 0; i < num_workers; i++) {
-            ProgressReport report;
-            ssize_t n = read(pipes_from_workers[i][0], &report, sizeof(ProgressReport));
-
-            if (n == sizeof(ProgressReport)) {
-                if (report.status == STATUS_DONE) {
-                    printf("[Master] Worker %d completed chunk %d\n",
-                           report.worker_pid, report.chunk_id);
-                    completed++;
-                } else if (report.status == STATUS_ERROR) {
-                    fprintf(stderr, "[Master] Worker %d reported error on chunk %d\n",
-                            report.worker_pid, report.chunk_id);
-                    completed++;
-                }
-            } else if (n == -1 && errno != EAGAIN && errno != EINTR) {
-                break;  // 에러 또는 EOF
-            }
-        }
+    // 워커 풀 생성 (실행당 한 번만 fork)
+    if (pool_start(num_workers) == -1) {
+        cleanup_shared_memory(shared_data);
+        shared_data = NULL;
+        return -1;
     }
 
-    // 모든 워커 종료 대기 (교안 ch07 기반)
-    printf("\n=== Waiting for workers to exit ===\n");
-    for (int i = 0; i < num_workers; i++) {
-        int status;
-        waitpid(worker_pids[i], &status, 0);
-
-        if (WIFEXITED(status)) {
-            int exit_code = WEXITSTATUS(status);
-            if (exit_code == 0) {
-                printf("[Master] Worker %d (PID %d) exited successfully\n",
-                       i, worker_pids[i]);
-            } else {
-                printf("[Master] Worker %d (PID %d) exited with error code %d\n",
-                       i, worker_pids[i], exit_code);
-            }
-        } else if (WIFSIGNALED(status)) {
-            printf("[Master] Worker %d (PID %d) killed by signal %d\n",
-                   i, worker_pids[i], WTERMSIG(status));
-        }
-    }
+    int result = run_file_on_pool(input_file, output_file, layout,
+                                  num_workers, mode, key, in_place, chunk_size);
 
-    // 파이프 닫기
-    for (int i = 0; i < num_workers; i++) {
-        close(pipes_to_workers[i][1]);
-        close(pipes_from_workers[i][0]);
-    }
+    // 워커 종료
+    pool_shutdown(num_workers);
 
     // 정리
     cleanup_shared_memory(shared_data);
     shared_data = NULL;
 
+    if (result == -1) {
+        return -1;
+    }
+
     gettimeofday(&end, NULL);
 
     printf("\n=== Processing Complete ===\n");
@@ -289,6 +500,7 @@ int process_single_file_multiprocess(const char *input_file, const char *output_
     printf("File size: %.2f MB\n", mb_size);
     printf("Processing time: %.3f seconds\n", elapsed);
     printf("Throughput: %.2f MB/s\n", throughput);
+    print_fault_stats(file_size);
     printf("Workers: %d\n", num_workers);
     printf("==============================\n");
 
@@ -303,18 +515,44 @@ int main(int argc, char *argv[]) {
     char mode = 0;  // 'e' or 'd'
     int num_workers = DEFAULT_WORKERS;
     int verbose = 0;
-
-    // 명령행 인자 파싱
+    int in_place = 0;
+    int use_threads = 0;
+    size_t chunk_size = 0;  // 0: 파일 크기와 워커 수로 자동 결정
+
+    // 명령행 인자 파싱 (긴 옵션은 짧은 옵션과 겹치지 않는 값 사용)
+    enum { OPT_DURABILITY = 256, OPT_AFFINITY, OPT_CIPHER, OPT_RANGE };
+    static int resume = 0;
+    static int incremental = 0;
+    static const struct option long_options[] = {
+        { "durability", required_argument, NULL, OPT_DURABILITY },
+        { "affinity", required_argument, NULL, OPT_AFFINITY },
+        { "populate", no_argument, &map_populate, 1 },
+        { "cipher", required_argument, NULL, OPT_CIPHER },
+        { "container", no_argument, &container_output, 1 },
+        { "range", required_argument, NULL, OPT_RANGE },
+        { "resume", no_argument, &resume, 1 },
+        { "incremental", no_argument, &incremental, 1 },
+        { NULL, 0, NULL, 0 }
+    };
+    int durability_set = 0;
+    const char *range_spec = NULL;
+    uint64_t range_offset = 0, range_length = 0;
     int opt;
-    while ((opt = getopt(argc, argv, "e:d:o:k:w:D:vh")) != -1) {
+    while ((opt = getopt_long(argc, argv, "e::d::o:k:w:c:D:iTUOvh",
+                              long_options, NULL)) != -1) {
         switch (opt) {
             case 'e':
-                mode = 'e';
-                input_file = optarg;
-                break;
             case 'd':
-                mode = 'd';
-                input_file = optarg;
+                // 파일 인자는 선택: 디렉터리 모드(-D)에서는 -e / -d 만으로 방향 지정
+                // "-"는 표준 입력 (스트리밍 모드)
+                mode = opt;
+                if (!optarg && optind < argc &&
+                    (argv[optind][0] != '-' || strcmp(argv[optind], "-") == 0)) {
+                    optarg = argv[optind++];
+                }
+                if (optarg) {
+                    input_file = optarg;
+                }
                 break;
             case 'o':
                 output_file = optarg;
@@ -330,9 +568,59 @@ int main(int argc, char *argv[]) {
                     exit(1);
                 }
                 break;
+            case 'c':
+                chunk_size = parse_size(optarg);
+                if (chunk_size < CHUNK_MIN_SIZE) {
+                    fprintf(stderr, "Error: Chunk size must be at least %d KB\n",
+                            CHUNK_MIN_SIZE / 1024);
+                    exit(1);
+                }
+                break;
             case 'D':
                 directory = optarg;
                 break;
+            case 'i':
+                in_place = 1;
+                break;
+            case 'T':
+                use_threads = 1;
+                break;
+            case 'U':
+                use_io_uring = 1;
+                break;
+            case 'O':
+                use_direct_io = 1;
+                break;
+            case OPT_DURABILITY:
+                durability_mode = parse_durability(optarg);
+                if (durability_mode == -1) {
+                    fprintf(stderr, "Error: Unknown durability '%s' "
+                            "(none, fdatasync, writebehind, chunk)\n", optarg);
+                    exit(1);
+                }
+                durability_set = 1;
+                break;
+            case OPT_CIPHER:
+                if (cipher_select(optarg) == -1) {
+                    fprintf(stderr, "Error: Unknown cipher '%s' (xor, chacha20)\n", optarg);
+                    exit(1);
+                }
+                break;
+            case OPT_RANGE:
+                if (parse_range(optarg, &range_offset, &range_length) == -1) {
+                    fprintf(stderr, "Error: Invalid range '%s' (e.g. 1048576:4096 or 1G:4K)\n",
+                            optarg);
+                    exit(1);
+                }
+                range_spec = optarg;
+                break;
+            case 0:
+                break;  // 플래그형 긴 옵션 (getopt_long이 직접 설정)
+            case OPT_AFFINITY:
+                if (affinity_setup(optarg) == -1) {
+                    exit(1);
+                }
+                break;
             case 'v':
                 verbose = 1;
                 break;
@@ -364,48 +652,247 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
+    // CPU 기능에 맞는 암호화 커널 선택 (fork 전에 한 번만)
+    crypto_init();
+
+    // 증분 모드: 파일 하나를 원시 출력으로 (자체 pread / pwrite 스레드 사용)
+    if (incremental) {
+        if (!input_file || strcmp(input_file, "-") == 0 || in_place || directory ||
+            range_spec || resume || container_output) {
+            fprintf(stderr, "Error: --incremental requires -e/-d <file> "
+                    "(not stdin, -i, -D, --range, --resume or --container)\n");
+            exit(1);
+        }
+        if (use_threads || use_io_uring || use_direct_io) {
+            printf("Note: Incremental mode uses its own block threads (-T, -U, -O ignored).\n");
+        }
+        use_threads = use_io_uring = use_direct_io = 0;
+    }
+
+    // 범위 복호화: 요청한 범위만 읽어 표준 출력 (또는 -o 파일)으로
+    // 출력 준비는 스트리밍 모드와 같음 (이후 메시지는 표준 에러로)
+    if (range_spec) {
+        if (mode != 'd' || !input_file || strcmp(input_file, "-") == 0 ||
+            in_place || directory || resume) {
+            fprintf(stderr, "Error: --range requires -d <file> "
+                    "(not stdin, -i, -D or --resume)\n");
+            exit(1);
+        }
+        int range_fd = stream_open_output(output_file);
+        if (range_fd == -1) {
+            exit(1);
+        }
+        return process_range(input_file, range_fd, key, range_offset,
+                             range_length) == 0 ? 0 : 1;
+    }
+
+    // 스트리밍 모드: 표준 입력 → 표준 출력 (또는 -o 파일)
+    // 데이터가 표준 출력으로 나가면 이후 메시지는 모두 표준 에러로
+    int stream_fd = -1;
+    if (input_file && strcmp(input_file, "-") == 0) {
+        if (in_place || directory || container_output || resume) {
+            fprintf(stderr, "Error: -i, -D, --container and --resume cannot be used with "
+                    "stdin input (-e - / -d -)\n");
+            exit(1);
+        }
+        stream_fd = stream_open_output(output_file);
+        if (stream_fd == -1) {
+            exit(1);
+        }
+        if (use_threads || use_io_uring || use_direct_io) {
+            printf("Note: Streaming mode uses its own buffer pipeline (-T, -U, -O ignored).\n");
+        }
+        use_threads = use_io_uring = use_direct_io = 0;
+    }
+
+    // io_uring 백엔드: 지원되지 않거나 적용할 수 없는 모드면 mmap 경로 사용
+    if (use_io_uring) {
+        if (!uring_available()) {
+            printf("Note: io_uring is not available (%s), using mmap backend.\n",
+                   strerror(errno));
+            use_io_uring = 0;
+        } else if (in_place) {
+            printf("Note: In-place mode uses the mmap backend (journal ordering).\n");
+            use_io_uring = 0;
+        } else if (use_threads && !directory) {
+            printf("Note: -U applies to worker processes, thread engine uses mmap.\n");
+        }
+    }
+
+    // 제자리 모드의 저널은 "청크 동기화 → 저널 갱신" 순서에 의존
+    if (in_place && durability_mode != DURABILITY_CHUNK) {
+        if (durability_set) {
+            printf("Note: In-place mode requires --durability chunk (journal ordering).\n");
+        }
+        durability_mode = DURABILITY_CHUNK;
+    }
+
+    // direct I/O: 제자리 모드는 저널 순서 때문에 mmap 경로 사용
+    if (use_direct_io) {
+        if (in_place) {
+            printf("Note: In-place mode uses the mmap backend (journal ordering).\n");
+            use_direct_io = 0;
+        } else {
+            if (use_io_uring) {
+                printf("Note: -O takes precedence over -U, using direct I/O.\n");
+                use_io_uring = 0;
+            }
+            // 디렉터리는 O_DIRECT로 열 수 없으므로 -D는 워커가 파일을 열 때 파일마다 안내
+            if (!directory && !direct_supported(input_file)) {
+                printf("Note: Filesystem does not support O_DIRECT, "
+                       "using buffered I/O with POSIX_FADV_DONTNEED.\n");
+            }
+        }
+    }
+
+    // 원시 chacha20 출력은 nonce가 0으로 고정: 같은 비밀번호로 암호화한 파일끼리 키스트림이 같음
+    // (-D는 트리의 모든 파일, 스트리밍은 모든 스트림이 같은 키스트림, --container만 파일별 nonce)
+    if (mode == 'e' && !container_output && strcmp(cipher_name(), "chacha20") == 0) {
+        fprintf(stderr, "Warning: Raw chacha20 output uses a fixed nonce, so %s "
+                "the same keystream as any other file encrypted with this password.\n",
+                directory ? "every file in this directory shares" :
+                stream_fd != -1 ? "this stream shares" : "this file shares");
+        fprintf(stderr, "         Use --container for a random per-file nonce%s.\n",
+                directory || stream_fd != -1 ? " (single-file mode only)" : "");
+    }
+
     // 시스템 정보 출력 (verbose 모드)
     if (verbose) {
         print_system_info();
+        printf("Cipher: %s\n", cipher_name());
+        printf("Crypto kernel: %s\n", crypto_kernel_name());
+        printf("I/O backend: %s\n", use_direct_io ? "direct" :
+                                     use_io_uring ? "io_uring" : "mmap");
+        printf("Durability: %s\n\n", durability_name(durability_mode));
+    }
+
+    if (stream_fd != -1) {
+        return process_stream(stream_fd, num_workers, mode, key) == 0 ? 0 : 1;
     }
 
     // 디렉터리 처리
     if (directory) {
-        printf("Directory processing not yet implemented in this phase.\n");
-        printf("Please specify a single file with -e or -d option.\n");
-        return 1;
+        if (in_place || output_file || container_output || resume) {
+            fprintf(stderr, "Error: -i, -o, --container and --resume cannot be used with "
+                    "directory mode (-D)\n");
+            exit(1);
+        }
+        if (use_threads) {
+            printf("Note: -T is not supported with -D, using worker processes.\n");
+        }
+        return process_directory(directory, num_workers, mode, key, chunk_size) == 0 ? 0 : 1;
+    }
+
+    // 제자리 모드: 출력은 입력 파일 자신
+    if (in_place) {
+        if (output_file || container_output || resume) {
+            fprintf(stderr, "Error: -o, --container and --resume cannot be used with "
+                    "in-place mode (-i)\n");
+            exit(1);
+        }
+        if (access(input_file, W_OK) == -1) {
+            fprintf(stderr, "Error: Cannot write file '%s'\n", input_file);
+            exit(1);
+        }
+        // 이전 실행이 중단된 흔적이 있으면 건드리지 않음
+        if (journal_exists(input_file)) {
+            fprintf(stderr, "Error: Found journal from an interrupted in-place run\n\n");
+            journal_print_report(input_file);
+            fprintf(stderr, "\nRefusing to modify '%s'. Restore the file or remove %s.journal\n",
+                    input_file, input_file);
+            exit(1);
+        }
+        output_file = input_file;
     }
 
     // 출력 파일명 자동 생성
     if (!output_file) {
         static char auto_output[MAX_PATH_LEN];
-        if (mode == 'e') {
-            snprintf(auto_output, sizeof(auto_output), "%s.encrypted", input_file);
-        } else {
-            // 복호화: .encrypted 확장자 제거 후 .decrypted 추가 (안전)
-            if (strstr(input_file, ".encrypted")) {
-                strncpy(auto_output, input_file, sizeof(auto_output) - 1);
-                char *ext = strstr(auto_output, ".encrypted");
-                if (ext) *ext = '\0';
-                strncat(auto_output, ".decrypted",
-                        sizeof(auto_output) - strlen(auto_output) - 1);
-            } else {
-                snprintf(auto_output, sizeof(auto_output), "%s.decrypted", input_file);
-            }
-        }
+        make_output_path(input_file, mode, auto_output, sizeof(auto_output));
         output_file = auto_output;
     }
 
+    // 데이터 배치 결정: 컨테이너 입력이면 헤더의 엔진과 nonce를 fork 전에 적용
+    FileLayout layout;
+    if (layout_prepare(&layout, input_file, mode, key, num_workers, chunk_size) == -1) {
+        exit(1);
+    }
+    if (in_place && layout.in_data != 0) {
+        fprintf(stderr, "Error: In-place mode (-i) cannot be used with container files\n");
+        exit(1);
+    }
+    if (incremental) {
+        if (layout.in_data != 0) {
+            fprintf(stderr, "Error: --incremental cannot be used with container files\n");
+            layout_release(&layout);
+            exit(1);
+        }
+        int result = process_incremental(input_file, output_file, num_workers, mode,
+                                         key, &layout);
+        layout_release(&layout);
+        return result == 0 ? 0 : 1;
+    }
+    if (use_io_uring && (layout.in_data != 0 || layout.out_data != 0)) {
+        printf("Note: Container files use the mmap backend (-U ignored).\n");
+        use_io_uring = 0;
+    }
+
+    // 빈 입력은 처리할 청크가 없으므로 진행 기록을 만들기 전에 거부
+    if (layout.data_size == 0) {
+        fprintf(stderr, "Error: File is empty or invalid\n");
+        layout_release(&layout);
+        exit(1);
+    }
+
+    // 진행 기록: 완료된 청크를 <출력>.journal에 남겨 중단되면 --resume으로 이어서 처리
+    // (제자리 모드는 자체 저널이 같은 파일을 쓰고, 중단된 청크를 다시 변환할 수 없음)
+    Journal progress = { .fd = -1 };
+    if (!in_place && layout_track(&layout, &progress, input_file, output_file, mode, key,
+                                  num_workers, chunk_size, resume) == -1) {
+        layout_release(&layout);
+        exit(1);
+    }
+    if (use_io_uring && layout.resume) {
+        printf("Note: --resume uses the mmap backend (-U ignored).\n");
+        use_io_uring = 0;
+    }
+
     // 단일 파일 처리
-    if (num_workers == 1 || get_file_size(input_file) < SMALL_FILE_THRESHOLD) {
+    int result;
+    if (num_workers == 1 || layout.data_size < SMALL_FILE_THRESHOLD) {
         // 단일 프로세스 모드
         if (num_workers > 1) {
             printf("Note: File is small (< 4MB), using single process mode for efficiency.\n");
         }
-        return process_single_file_simple(input_file, output_file, mode, key);
+        result = process_single_file_simple(input_file, output_file, mode, key,
+                                            in_place, &layout);
+    } else if (use_threads) {
+        // 멀티스레드 모드 (-T): Ctrl+C는 종료 플래그만 세우고 아래에서 진행 기록을 정리
+        setup_signal_handlers();
+        setup_stop_handlers();
+        result = process_single_file_threaded(input_file, output_file,
+                                              num_workers, mode, key, in_place,
+                                              chunk_size, &layout);
     } else {
         // 멀티프로세스 모드 (2단계)
-        return process_single_file_multiprocess(input_file, output_file,
-                                                 num_workers, mode, key);
+        result = process_single_file_multiprocess(input_file, output_file,
+                                                  num_workers, mode, key, in_place,
+                                                  chunk_size, &layout);
+    }
+
+    // 완료되면 진행 기록 삭제, 실패하거나 중단되면 남겨 두고 재개 방법 안내
+    // 완료된 청크가 없거나 다시 실행해도 실패할 경우(청크 손상)는 이어서 처리할 것이 없으므로 삭제
+    if (progress.header) {
+        if (result == 0 || atomic_load(&progress.unresumable) ||
+            journal_chunks_done(&progress) == 0) {
+            journal_remove(&progress);
+        } else {
+            journal_close(&progress);
+            fprintf(stderr, "Progress saved in %s.journal, run again with --resume "
+                    "to process only the missing chunks\n", output_file);
+        }
     }
+
+    layout_release(&layout);
+    return result;
 }
@@ -0,0 +1,256 @@
+#define _GNU_SOURCE     // cpu_set_t, sched_setaffinity
+#include "crypto_system.h"
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+// NUMA 토폴로지와 워커 CPU 고정 (--affinity)
+//
+// 고정하지 않은 워커는 스케줄러가 소켓 사이로 옮기므로, 한 워커가 폴트로 올린 페이지가
+// 다른 소켓 메모리에 남고 원격 접근이 늘어난다. 토폴로지는 libnuma 없이
+// /sys/devices/system/node/node<N>/cpulist에서 읽고, 워커마다 CPU 하나에 고정한 뒤
+// set_mempolicy(MPOL_PREFERRED)로 그 CPU의 노드에서 메모리를 먼저 할당받게 한다.
+// 워커가 고정된 뒤 할당하는 매핑 페이지, io_uring 버퍼 등은 로컬 노드에 놓인다.
+//  - numa: 노드를 번갈아 가며 배치 (워커 0 → 노드 0, 워커 1 → 노드 1, ...)
+//  - CPU 목록 ("0-3,8-11"): 워커 i는 목록의 i번째 CPU (목록보다 워커가 많으면 처음부터 반복)
+
+#define NUMA_SYSFS "/sys/devices/system/node"
+
+typedef struct {
+    int id;                 // 노드 번호
+    cpu_set_t cpus;         // 이 프로세스가 쓸 수 있는 노드의 CPU
+    int num_cpus;
+} NumaNode;
+
+static NumaNode nodes[MAX_NUMA_NODES];
+static int num_nodes = 0;
+
+static int plan[MAX_WORKERS];       // 워커별 CPU (-1이면 고정하지 않음)
+static int plan_enabled = 0;
+static char plan_spec[64];          // 출력용 ("numa" 또는 CPU 목록)
+
+// CPU 목록 파싱 ("0-3,8,10-11" 형식, sysfs cpulist와 같음)
+static int parse_cpu_list(const char *str, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *p = str;
+
+    while (*p && *p != '\n') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p || first < 0) {
+            return -1;
+        }
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first) {
+                return -1;
+            }
+        }
+        if (last >= CPU_SETSIZE) {
+            return -1;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, set);
+        }
+
+        p = end;
+        if (*p == ',') {
+            p++;
+        } else if (*p && *p != '\n') {
+            return -1;
+        }
+    }
+    return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+
+// 토폴로지 탐지 (한 번만, sysfs가 없으면 허용된 CPU 전체를 노드 하나로)
+static void numa_detect(void) {
+    if (num_nodes > 0) {
+        return;
+    }
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+        CPU_ZERO(&allowed);
+        for (long i = 0; i < sysconf(_SC_NPROCESSORS_ONLN) && i < CPU_SETSIZE; i++) {
+            CPU_SET(i, &allowed);
+        }
+    }
+
+    DIR *dir = opendir(NUMA_SYSFS);
+    struct dirent *entry;
+    while (dir && (entry = readdir(dir)) != NULL && num_nodes < MAX_NUMA_NODES) {
+        int id;
+        char extra;
+        if (sscanf(entry->d_name, "node%d%c", &id, &extra) != 1) {
+            continue;
+        }
+
+        char path[MAX_PATH_LEN];
+        char buf[4096];
+        snprintf(path, sizeof(path), NUMA_SYSFS "/%s/cpulist", entry->d_name);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            continue;
+        }
+        ssize_t n = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+        if (n <= 0) {
+            continue;   // CPU 없는 메모리 전용 노드
+        }
+        buf[n] = '\0';
+
+        NumaNode *node = &nodes[num_nodes];
+        if (parse_cpu_list(buf, &node->cpus) == -1) {
+            continue;
+        }
+        CPU_AND(&node->cpus, &node->cpus, &allowed);
+        node->num_cpus = CPU_COUNT(&node->cpus);
+        if (node->num_cpus == 0) {
+            continue;
+        }
+        node->id = id;
+        num_nodes++;
+    }
+    if (dir) {
+        closedir(dir);
+    }
+
+    // readdir 순서는 정해져 있지 않으므로 노드 번호순 정렬
+    for (int i = 1; i < num_nodes; i++) {
+        for (int j = i; j > 0 && nodes[j].id < nodes[j - 1].id; j--) {
+            NumaNode tmp = nodes[j];
+            nodes[j] = nodes[j - 1];
+            nodes[j - 1] = tmp;
+        }
+    }
+
+    if (num_nodes == 0) {
+        nodes[0].id = 0;
+        nodes[0].cpus = allowed;
+        nodes[0].num_cpus = CPU_COUNT(&allowed);
+        num_nodes = 1;
+    }
+}
+
+// 노드 안에서 index번째 CPU
+static int node_cpu(const NumaNode *node, int index) {
+    index %= node->num_cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &node->cpus) && index-- == 0) {
+            return cpu;
+        }
+    }
+    return -1;
+}
+
+// CPU가 속한 노드 (모르면 -1)
+static int cpu_node(int cpu) {
+    for (int i = 0; i < num_nodes; i++) {
+        if (CPU_ISSET(cpu, &nodes[i].cpus)) {
+            return nodes[i].id;
+        }
+    }
+    return -1;
+}
+
+// 배치 계획 ("numa" 또는 CPU 목록), fork 전에 main에서 호출
+int affinity_setup(const char *spec) {
+    numa_detect();
+
+    if (strcmp(spec, "numa") == 0) {
+        for (int i = 0; i < MAX_WORKERS; i++) {
+            plan[i] = node_cpu(&nodes[i % num_nodes], i / num_nodes);
+        }
+    } else {
+        cpu_set_t set;
+        if (parse_cpu_list(spec, &set) == -1) {
+            fprintf(stderr, "Error: Invalid CPU list '%s' (e.g. 0-3,8-11)\n", spec);
+            return -1;
+        }
+
+        int cpus[CPU_SETSIZE];
+        int count = 0;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &set)) {
+                continue;
+            }
+            if (cpu_node(cpu) < 0) {
+                fprintf(stderr, "Error: CPU %d is not available to this process\n", cpu);
+                return -1;
+            }
+            cpus[count++] = cpu;
+        }
+        for (int i = 0; i < MAX_WORKERS; i++) {
+            plan[i] = cpus[i % count];
+        }
+    }
+
+    plan_enabled = 1;
+    snprintf(plan_spec, sizeof(plan_spec), "%s",
+             strcmp(spec, "numa") == 0 ? "numa (round-robin over nodes)" : spec);
+    return 0;
+}
+
+// 호출한 프로세스(또는 스레드)를 계획된 CPU에 고정하고 메모리를 그 노드에서 우선 할당
+// 워커 프로세스는 fork 직후, 스레드 엔진은 스레드 시작 시 호출
+void affinity_apply(int worker_id) {
+    if (!plan_enabled || plan[worker_id] < 0) {
+        return;
+    }
+
+    int cpu = plan[worker_id];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+        fprintf(stderr, "[Worker %d] sched_setaffinity(CPU %d): %s\n",
+                worker_id, cpu, strerror(errno));
+        return;
+    }
+
+    // 노드가 하나뿐이면 메모리 정책은 의미 없음
+    int node = cpu_node(cpu);
+    if (num_nodes > 1 && node >= 0) {
+        unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long)) + 1] = { 0 };
+        mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask,
+                    sizeof(mask) * 8) == -1) {
+            fprintf(stderr, "[Worker %d] set_mempolicy(node %d): %s\n",
+                    worker_id, node, strerror(errno));
+        }
+    }
+
+    printf("[Worker %d] Pinned to CPU %d (node %d)\n", worker_id, cpu, node);
+}
+
+// 탐지한 토폴로지와 배치 계획 출력 (print_system_info에서 호출)
+void print_numa_topology(void) {
+    numa_detect();
+
+    printf("NUMA nodes: %d\n", num_nodes);
+    for (int i = 0; i < num_nodes; i++) {
+        printf("  Node %d: %d CPUs (", nodes[i].id, nodes[i].num_cpus);
+        // 연속된 CPU는 범위로 출력
+        const char *sep = "";
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &nodes[i].cpus)) {
+                continue;
+            }
+            int last = cpu;
+            while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &nodes[i].cpus)) {
+                last++;
+            }
+            printf(last == cpu ? "%s%d" : "%s%d-%d", sep, cpu, last);
+            sep = ",";
+            cpu = last;
+        }
+        printf(")\n");
+    }
+
+    if (plan_enabled) {
+        printf("Worker affinity: %s\n", plan_spec);
+    }
+}
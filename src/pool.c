@@ -0,0 +1,610 @@
+#include "crypto_system.h"
+
+// 영속 워커 풀 (교안 ch07, ch10 기반)
+// 워커는 실행당 한 번만 fork되고, 작업 파이프에서 WorkTask를 반복해서 받아 처리한다.
+// TASK_SHUTDOWN 메시지를 받을 때만 종료하므로 파일마다 fork/파이프 비용을 치르지 않는다.
+//
+// 마스터는 모든 보고 파이프와 signalfd를 epoll 하나로 기다린다 (pool_wait).
+// 보고는 도착한 순서대로 처리되고, SIGCHLD/SIGINT/SIGTERM은 비동기 핸들러 대신
+// 이벤트로 받으므로 자식 회수와 종료 처리가 모두 이벤트 루프 안에서 일어난다.
+
+// 전역 변수 (extern으로 main.c에서 선언된 것 사용)
+extern pid_t worker_pids[];
+extern int pipes_to_workers[][2];
+extern int pipes_from_workers[][2];
+extern SharedData *shared_data;
+
+#define POOL_SIGNAL_TAG MAX_WORKERS   // epoll 데이터: signalfd 표시
+#define POOL_WATCH_TAG (MAX_WORKERS + 1)  // epoll 데이터: pool_watch_fd로 등록한 fd
+#define POOL_QUEUE_DEPTH 2            // 워커당 미리 보내 두는 작업 수 (파이프 왕복 지연 숨김)
+#define POOL_QUEUE_MAX URING_MAX_TASKS  // io_uring 워커는 여러 파일을 함께 처리하므로 더 많이
+
+// 이벤트 루프 상태 (마스터 전용)
+static int pool_size = 0;
+static int epoll_fd = -1;
+static int signal_fd = -1;
+static sigset_t saved_mask;
+
+static struct epoll_event ready[MAX_WORKERS + 2];
+static int ready_count = 0;
+static int ready_next = 0;
+
+// 회수되었지만 아직 이벤트로 전달하지 않은 워커
+static int exit_pending[MAX_WORKERS];
+static int exit_status[MAX_WORKERS];
+static pid_t exited_pids[MAX_WORKERS];
+
+// 워커 종료 상태 출력
+static void print_exit_status(int worker_id, pid_t pid, int status) {
+    if (WIFEXITED(status)) {
+        int exit_code = WEXITSTATUS(status);
+        if (exit_code == 0) {
+            printf("[Master] Worker %d (PID %d) exited successfully\n", worker_id, pid);
+        } else {
+            printf("[Master] Worker %d (PID %d) exited with error code %d\n",
+                   worker_id, pid, exit_code);
+        }
+    } else if (WIFSIGNALED(status)) {
+        printf("[Master] Worker %d (PID %d) killed by signal %d\n",
+               worker_id, pid, WTERMSIG(status));
+    }
+}
+
+// 이벤트 루프 준비: 보고 파이프와 signalfd를 epoll에 등록
+static int pool_events_init(int num_workers) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+
+    signal_fd = signalfd(-1, &mask, SFD_CLOEXEC);
+    if (signal_fd == -1) {
+        perror("signalfd");
+        return -1;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        perror("epoll_create1");
+        close(signal_fd);
+        signal_fd = -1;
+        return -1;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = POOL_SIGNAL_TAG };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &ev) == -1) {
+        perror("epoll_ctl signalfd");
+        return -1;
+    }
+
+    for (int i = 0; i < num_workers; i++) {
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipes_from_workers[i][0], &ev) == -1) {
+            perror("epoll_ctl pipe");
+            return -1;
+        }
+    }
+
+    ready_count = ready_next = 0;
+    return 0;
+}
+
+// 종료한 워커들을 논블로킹으로 회수 (SIGCHLD는 합쳐질 수 있으므로 전부 확인)
+static void pool_reap(void) {
+    for (int i = 0; i < pool_size; i++) {
+        int status;
+        if (worker_pids[i] > 0 && waitpid(worker_pids[i], &status, WNOHANG) > 0) {
+            exited_pids[i] = worker_pids[i];
+            exit_status[i] = status;
+            exit_pending[i] = 1;
+            worker_pids[i] = 0;
+        }
+    }
+}
+
+// 워커 프로세스 생성
+int pool_start(int num_workers) {
+    // 파이프 생성 (교안 ch10 기반)
+    printf("Creating pipes...\n");
+    if (create_pipes(pipes_to_workers, pipes_from_workers, num_workers) == -1) {
+        return -1;
+    }
+
+    // direct I/O 버퍼 풀은 fork 전에 공유 메모리에 만들어 모든 워커가 함께 사용
+    if (use_direct_io && !direct_pool) {
+        direct_pool = direct_pool_create(num_workers);
+        if (!direct_pool) {
+            for (int i = 0; i < num_workers; i++) {
+                close(pipes_to_workers[i][0]);
+                close(pipes_to_workers[i][1]);
+                close(pipes_from_workers[i][0]);
+                close(pipes_from_workers[i][1]);
+            }
+            return -1;
+        }
+    }
+
+    // fork 전에 시그널을 막아 두어야 워커가 바로 종료해도 SIGCHLD를 놓치지 않음
+    // (막힌 시그널은 대기 상태로 남았다가 signalfd로 읽힘)
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, &saved_mask);
+
+    // 워커 프로세스 생성 (교안 ch07 예제 7-2 기반)
+    printf("Creating %d worker processes...\n", num_workers);
+    for (int i = 0; i < num_workers; i++) {
+        // 자식에게 버퍼가 복제되어 중복 출력되지 않도록 fork 전에 비움
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+
+        if (pid == -1) {
+            perror("fork");
+            // 이미 생성된 워커들 정리
+            for (int j = 0; j < i; j++) {
+                kill(worker_pids[j], SIGTERM);
+                waitpid(worker_pids[j], NULL, 0);
+                worker_pids[j] = 0;
+                close(pipes_to_workers[j][1]);
+                close(pipes_from_workers[j][0]);
+            }
+            for (int j = i; j < num_workers; j++) {
+                close(pipes_to_workers[j][0]);
+                close(pipes_to_workers[j][1]);
+                close(pipes_from_workers[j][0]);
+                close(pipes_from_workers[j][1]);
+            }
+            sigprocmask(SIG_SETMASK, &saved_mask, NULL);
+            direct_pool_destroy(direct_pool);
+            direct_pool = NULL;
+            return -1;
+        }
+
+        if (pid == 0) {  // 자식 프로세스 (워커)
+            // 종료는 마스터가 shutdown_flag로 조율하므로 터미널의 SIGINT는 무시
+            // (진행 중인 청크와 저널 기록을 끝까지 마치고 빠져나감)
+            signal(SIGINT, SIG_IGN);
+            sigprocmask(SIG_SETMASK, &saved_mask, NULL);
+
+            // --affinity: 매핑과 버퍼를 할당하기 전에 CPU와 메모리 노드 고정
+            affinity_apply(i);
+
+            // 사용하지 않는 파이프 닫기
+            close_unused_pipes(pipes_to_workers, pipes_from_workers,
+                               num_workers, i);
+
+            worker_main(i, pipes_to_workers[i][0], pipes_from_workers[i][1],
+                        shared_data);
+            exit(0);  // worker_main에서 exit하지만 명시적으로 추가
+        }
+
+        // 부모 프로세스
+        worker_pids[i] = pid;
+        exit_pending[i] = 0;
+        close(pipes_to_workers[i][0]);      // 읽기 끝 닫기
+        close(pipes_from_workers[i][1]);    // 쓰기 끝 닫기
+    }
+
+    pool_size = num_workers;
+    if (pool_events_init(num_workers) == -1) {
+        pool_shutdown(num_workers);
+        return -1;
+    }
+
+    printf("[Master] All workers created\n\n");
+    return 0;
+}
+
+// 워커에게 작업 전달
+int pool_submit(int worker_id, const WorkTask *task) {
+    if (write_full(pipes_to_workers[worker_id][1], task, sizeof(WorkTask)) == -1) {
+        perror("[Master] write task");
+        return -1;
+    }
+    return 0;
+}
+
+// 다음 이벤트 대기 (블로킹)
+// 보고, 워커 종료, 중단 요청 중 먼저 도착한 것을 하나씩 돌려준다.
+int pool_wait(PoolEvent *event) {
+    memset(event, 0, sizeof(*event));
+
+    while (1) {
+        // 회수된 워커가 있으면 먼저 전달
+        for (int i = 0; i < pool_size; i++) {
+            if (exit_pending[i]) {
+                exit_pending[i] = 0;
+                event->type = POOL_EVENT_EXIT;
+                event->worker_id = i;
+                event->status = exit_status[i];
+                return 0;
+            }
+        }
+
+        if (ready_next == ready_count) {
+            int n = epoll_wait(epoll_fd, ready, MAX_WORKERS + 2, -1);
+            if (n == -1) {
+                if (errno == EINTR) continue;
+                perror("epoll_wait");
+                return -1;
+            }
+            ready_count = n;
+            ready_next = 0;
+        }
+
+        struct epoll_event *ev = &ready[ready_next++];
+        int tag = ev->data.u32;
+
+        if (tag == POOL_WATCH_TAG) {
+            event->type = POOL_EVENT_WATCH;
+            return 0;
+        }
+
+        if (tag == POOL_SIGNAL_TAG) {
+            struct signalfd_siginfo info;
+            ssize_t n = read(signal_fd, &info, sizeof(info));
+            if (n != sizeof(info)) {
+                continue;  // 같은 묶음에서 이미 읽음
+            }
+            if (info.ssi_signo == SIGCHLD) {
+                pool_reap();
+                continue;
+            }
+            event->type = POOL_EVENT_INTERRUPT;
+            event->status = info.ssi_signo;
+            return 0;
+        }
+
+        // 보고는 PIPE_BUF보다 작아 원자적으로 기록되므로 읽을 수 있으면 온전히 도착해 있음
+        ssize_t n = read_full(pipes_from_workers[tag][0], &event->report,
+                              sizeof(ProgressReport));
+        if (n == sizeof(ProgressReport)) {
+            event->type = POOL_EVENT_REPORT;
+            event->worker_id = tag;
+            return 0;
+        }
+
+        // EOF 또는 오류: 워커가 파이프를 닫음, 종료는 SIGCHLD로 보고됨
+        if (n == -1) perror("[Master] read report");
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipes_from_workers[tag][0], NULL);
+    }
+}
+
+// 외부 fd를 이벤트 루프에 등록 (읽기 가능하면 POOL_EVENT_WATCH)
+int pool_watch_fd(int fd) {
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = POOL_WATCH_TAG };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        perror("epoll_ctl watch");
+        return -1;
+    }
+    return 0;
+}
+
+// 아직 시작하지 않은 파일들 (크기 기준 최대 힙: 지금까지 찾은 파일 중 가장 큰 것부터)
+typedef struct {
+    FileJob **items;
+    int count;
+    int capacity;
+} FileHeap;
+
+static int heap_push(FileHeap *h, FileJob *f) {
+    if (h->count == h->capacity) {
+        int capacity = h->capacity ? h->capacity * 2 : 1024;
+        FileJob **grown = realloc(h->items, capacity * sizeof(FileJob*));
+        if (!grown) {
+            perror("realloc");
+            return -1;
+        }
+        h->items = grown;
+        h->capacity = capacity;
+    }
+
+    int i = h->count++;
+    while (i > 0 && h->items[(i - 1) / 2]->size < f->size) {
+        h->items[i] = h->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->items[i] = f;
+    return 0;
+}
+
+static FileJob* heap_pop(FileHeap *h) {
+    if (h->count == 0) {
+        return NULL;
+    }
+
+    FileJob *top = h->items[0];
+    FileJob *last = h->items[--h->count];
+    int i = 0;
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= h->count) break;
+        if (child + 1 < h->count && h->items[child + 1]->size > h->items[child]->size) {
+            child++;
+        }
+        if (h->items[child]->size <= last->size) break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    if (h->count > 0) {
+        h->items[i] = last;
+    }
+    return top;
+}
+
+// 파일 스케줄링 상태 (pool_run_files)
+typedef struct {
+    FileHeap heap;          // 대기 중인 파일
+    FileJob *current;       // 청크를 나누어 보내는 중인 파일
+    int next_chunk;         // current에서 다음 청크 번호
+    int num_workers;
+    size_t chunk_size;      // -c 값 (0이면 자동)
+    char mode;
+} FileCursor;
+
+// 파일 하나를 시작할 때 출력 파일 생성과 청크 분할 (마스터에서 한 번만)
+static int file_job_begin(FileCursor *cur, FileJob *f) {
+    if (strlen(f->input_file) >= MAX_PATH_LEN || strlen(f->output_file) >= MAX_PATH_LEN) {
+        fprintf(stderr, "[Master] Path too long: %s\n", f->input_file);
+        return -1;
+    }
+
+    // 컨테이너는 헤더의 엔진과 nonce가 실행 전체에 적용되므로 단일 파일 모드에서만 처리
+    if (cur->mode == 'd' && container_probe(f->input_file) == 1) {
+        fprintf(stderr, "[Master] Skipping container '%s' (decrypt it with -d <file>)\n",
+                f->input_file);
+        return -1;
+    }
+
+    int out_fd = create_output_file(f->output_file, f->size);
+    if (out_fd == -1) {
+        fprintf(stderr, "[Master] Cannot create '%s'\n", f->output_file);
+        return -1;
+    }
+    close(out_fd);
+
+    // 큰 파일만 청크로 나누어 여러 워커에 분산, 작은 파일은 워커 하나가 통째로 처리
+    f->chunk_size = f->size >= SMALL_FILE_THRESHOLD ?
+                    choose_chunk_size(f->size, cur->num_workers, cur->chunk_size) :
+                    f->size;
+    f->num_chunks = f->size == 0 ? 0 : (f->size + f->chunk_size - 1) / f->chunk_size;
+    f->chunks_left = f->num_chunks;
+    return 0;
+}
+
+// 다음 작업 생성 (큰 파일부터, 큰 파일은 청크 단위)
+// 지금 보낼 작업이 없으면 NULL, 있으면 해당 파일 반환
+static FileJob* file_cursor_next(FileCursor *cur, WorkTask *task) {
+    while (1) {
+        if (!cur->current) {
+            FileJob *f = heap_pop(&cur->heap);
+            if (!f) {
+                return NULL;
+            }
+            if (file_job_begin(cur, f) == -1) {
+                f->failed = 1;
+                continue;
+            }
+            if (f->num_chunks == 0) {
+                continue;  // 빈 파일: 출력 생성만으로 완료
+            }
+            cur->current = f;
+            cur->next_chunk = 0;
+        }
+
+        FileJob *f = cur->current;
+        int chunk_id = cur->next_chunk;
+        off_t offset = (off_t)chunk_id * f->chunk_size;
+
+        task->type = TASK_RUN;
+        task->chunk_id = chunk_id;
+        task->offset = offset;
+        task->size = f->size - offset < f->chunk_size ? f->size - offset : f->chunk_size;
+        task->file_size = f->size;
+        task->chunk_size = f->chunk_size;
+        task->num_chunks = f->num_chunks;
+        task->operation = cur->mode;
+        task->in_place = 0;
+        strcpy(task->input_file, f->input_file);
+        strcpy(task->output_file, f->output_file);
+
+        if (++cur->next_chunk == f->num_chunks) {
+            cur->current = NULL;
+        }
+        return f;
+    }
+}
+
+// 탐색기가 찾은 파일들을 대기 힙과 전체 목록에 추가
+static void take_walker_files(DirWalker *walker, FileCursor *cur,
+                              FileJob **all, int *walk_done) {
+    FileJob *f = walker_take(walker, walk_done);
+    while (f) {
+        FileJob *next = f->next;
+        f->next = *all;
+        *all = f;
+        f->chunks_left = -1;  // 시작 전 (file_job_begin에서 청크 수로 설정)
+        shared_data->total_bytes += f->size;
+        if (heap_push(&cur->heap, f) == -1) {
+            f->failed = 1;
+        }
+        f = next;
+    }
+}
+
+// 디렉터리 탐색기가 찾는 파일들을 워커 풀에서 처리 (워커는 이미 생성되어 있음)
+// 탐색이 끝나기를 기다리지 않고, 찾은 파일 중 가장 큰 것부터 작업을 보낸다.
+// 워커마다 POOL_QUEUE_DEPTH개(io_uring은 POOL_QUEUE_MAX개)까지 작업을 미리 보내 두고,
+// 워커가 작업 하나를 끝냈다는 보고(STATUS_IDLE)가 도착하는 즉시 다음 작업을 보낸다.
+// *files에 모든 파일 목록(next로 연결)을 돌려주고, 실패한 파일 수를 반환한다.
+int pool_run_files(DirWalker *walker, int num_workers, char mode,
+                   const char *key, size_t chunk_size, FileJob **files) {
+    FileCursor cur = {
+        .num_workers = num_workers,
+        .chunk_size = chunk_size,
+        .mode = mode,
+    };
+    *files = NULL;
+
+    // 워커별 처리 중인 작업의 파일 (워커는 받은 순서대로 처리)
+    FileJob *queue[MAX_WORKERS][POOL_QUEUE_MAX];
+    int depth = use_io_uring ? POOL_QUEUE_MAX : POOL_QUEUE_DEPTH;
+    int queue_head[MAX_WORKERS] = { 0 };
+    int queue_len[MAX_WORKERS] = { 0 };
+    int alive[MAX_WORKERS];
+
+    WorkTask task;
+    memset(&task, 0, sizeof(task));
+    strncpy(task.key, key, sizeof(task.key) - 1);
+
+    shared_reset(shared_data, 0, 0);
+    if (pool_watch_fd(walker_event_fd(walker)) == -1) {
+        return -1;
+    }
+
+    int walk_done = 0;
+    int stopping = 0;
+    int in_flight = 0;
+    int any_alive = num_workers;
+    for (int i = 0; i < num_workers; i++) {
+        alive[i] = 1;
+    }
+
+    while (1) {
+        // 빈 자리가 있는 워커에게 작업 보내기
+        for (int i = 0; i < num_workers && !stopping; i++) {
+            while (alive[i] && queue_len[i] < depth) {
+                FileJob *f = file_cursor_next(&cur, &task);
+                if (!f) {
+                    break;
+                }
+                if (pool_submit(i, &task) == -1) {
+                    f->failed = 1;
+                    alive[i] = 0;
+                    any_alive--;
+                    break;
+                }
+                queue[i][(queue_head[i] + queue_len[i]) % depth] = f;
+                queue_len[i]++;
+                in_flight++;
+            }
+        }
+
+        // 보낸 작업이 모두 끝났고 더 보낼 것도 없으면 종료
+        int more = !stopping && any_alive > 0 &&
+                   (!walk_done || cur.heap.count > 0 || cur.current);
+        if (in_flight == 0 && !more) {
+            break;
+        }
+
+        PoolEvent event;
+        if (pool_wait(&event) == -1) {
+            break;
+        }
+
+        int w = event.worker_id;
+        if (event.type == POOL_EVENT_WATCH) {
+            take_walker_files(walker, &cur, files, &walk_done);
+        } else if (event.type == POOL_EVENT_INTERRUPT) {
+            if (stopping++) {
+                break;
+            }
+            printf("\n[Master] Received signal %d, finishing queued tasks...\n",
+                   event.status);
+            atomic_store(&shared_data->shutdown_flag, 1);
+        } else if (event.type == POOL_EVENT_EXIT) {
+            // 워커가 죽으면 보낸 작업들은 처리되지 않은 것으로 간주
+            if (alive[w]) {
+                alive[w] = 0;
+                any_alive--;
+            }
+            if (queue_len[w] > 0) {
+                fprintf(stderr, "[Master] Lost connection to worker %d\n", w);
+            }
+            for (; queue_len[w] > 0; queue_len[w]--, in_flight--) {
+                queue[w][queue_head[w]]->failed = 1;
+                queue_head[w] = (queue_head[w] + 1) % depth;
+            }
+        } else if (queue_len[w] > 0) {
+            FileJob *f = queue[w][queue_head[w]];
+
+            if (event.report.status == STATUS_IDLE) {
+                queue_head[w] = (queue_head[w] + 1) % depth;
+                queue_len[w]--;
+                in_flight--;
+            } else if (event.report.status == STATUS_DONE) {
+                f->chunks_left--;
+            } else {
+                fprintf(stderr, "[Master] Worker %d failed on '%s' (chunk %d)\n",
+                        w, f->input_file, event.report.chunk_id);
+                f->failed = 1;
+            }
+        }
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, walker_event_fd(walker), NULL);
+    free(cur.heap.items);
+
+    // 중단되어 시작하지 못했거나 끝나지 않은 파일은 실패로 기록
+    // fdatasync / writebehind 정책은 워커를 멈추지 않도록 모든 작업이 끝난 뒤 파일마다 동기화
+    int failed = 0;
+    for (FileJob *f = *files; f; f = f->next) {
+        if (f->failed || f->chunks_left != 0 || durability_finish(f->output_file) == -1) {
+            f->failed = 1;
+            failed++;
+        }
+    }
+    return failed;
+}
+
+// 종료 메시지 전송 후 모든 워커 종료 대기 (교안 ch07 기반)
+void pool_shutdown(int num_workers) {
+    WorkTask task;
+    memset(&task, 0, sizeof(task));
+    task.type = TASK_SHUTDOWN;
+
+    for (int i = 0; i < num_workers; i++) {
+        if (worker_pids[i] > 0) {
+            pool_submit(i, &task);
+        }
+        close(pipes_to_workers[i][1]);
+    }
+
+    printf("\n=== Waiting for workers to exit ===\n");
+    for (int i = 0; i < num_workers; i++) {
+        int status;
+        if (worker_pids[i] > 0 && waitpid(worker_pids[i], &status, 0) > 0) {
+            print_exit_status(i, worker_pids[i], status);
+        } else if (exited_pids[i] > 0) {
+            // 이벤트 루프에서 이미 회수한 경우
+            print_exit_status(i, exited_pids[i], exit_status[i]);
+        }
+
+        close(pipes_from_workers[i][0]);
+        worker_pids[i] = 0;
+        exited_pids[i] = 0;
+        exit_pending[i] = 0;
+    }
+
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+    if (signal_fd != -1) {
+        close(signal_fd);
+        signal_fd = -1;
+    }
+    pool_size = 0;
+
+    direct_pool_destroy(direct_pool);
+    direct_pool = NULL;
+
+    // 대기 중인 SIGCHLD는 복원 후 sigchld_handler가 처리 (회수할 자식 없음)
+    sigprocmask(SIG_SETMASK, &saved_mask, NULL);
+}
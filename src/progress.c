@@ -7,19 +7,14 @@ void* progress_thread_func(void *arg) {
     printf("\n[Progress] Monitoring started\n");
 
     while (1) {
-        pthread_mutex_lock(&shared->mutex);
-
-        int completed = shared->completed_chunks;
+        // 잠금 없이 워커별 슬롯을 읽어 합산 (워커의 기록을 막지 않음)
+        int completed = shared_completed_chunks(shared);
         int total = shared->total_chunks;
-        int shutdown = shared->shutdown_flag;
-
-        // 각 워커의 진행률 확인
-        double total_progress = 0.0;
-        for (int i = 0; i < total && i < MAX_WORKERS; i++) {
-            total_progress += shared->worker_progress[i];
-        }
+        int shutdown = atomic_load(&shared->shutdown_flag);
 
-        pthread_mutex_unlock(&shared->mutex);
+        uint64_t total_bytes = shared->total_bytes;
+        double total_progress = total_bytes > 0 ?
+                                (double)shared_bytes_done(shared) / total_bytes : 0.0;
 
         // 종료 확인
         if (shutdown || completed >= total) {
@@ -27,12 +22,12 @@ void* progress_thread_func(void *arg) {
         }
 
         // 진행률 계산
-        float percentage = total > 0 ? (total_progress / total * 100.0) : 0.0;
+        float percentage = total_progress * 100.0;
 
         // 진행률 바 출력
         printf("\r[Progress] ");
         int bar_width = 40;
-        int pos = total > 0 ? (int)(bar_width * total_progress / total) : 0;
+        int pos = (int)(bar_width * total_progress);
 
         printf("[");
         for (int i = 0; i < bar_width; i++) {
@@ -0,0 +1,185 @@
+#include "crypto_system.h"
+
+// SHA-256 (FIPS 180-4)
+// ChaCha20 키 유도(비밀번호 → 256비트 키)와 증분 모드의 블록 해시에 사용
+// 증분 모드는 입력 전체를 해시하므로 CPU에 SHA 확장(SHA-NI)이 있으면
+// sha256rnds2 / sha256msg1 / sha256msg2 명령으로 압축 함수를 계산한다 (없으면 이식 가능한 구현).
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROTR32(v, n) (((v) >> (n)) | ((v) << (32 - (n))))
+
+static void sha256_compress(uint32_t state[8], const unsigned char block[64]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t s1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i];
+        uint32_t s0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static void sha256_blocks_portable(uint32_t state[8], const unsigned char *data,
+                                   size_t blocks) {
+    for (; blocks; blocks--, data += 64) {
+        sha256_compress(state, data);
+    }
+}
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#include <cpuid.h>
+
+// SHA-NI: 상태를 ABEF / CDGH 두 레지스터로 두고 sha256rnds2 한 번에 2라운드
+// 메시지 일정은 4워드 묶음 단위로 W[t] = s1(W[t-2]) + W[t-7] + s0(W[t-15]) + W[t-16]
+__attribute__((target("sha,sse4.1")))
+static void sha256_blocks_ni(uint32_t state[8], const unsigned char *data, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);      // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);            // CDGH
+
+    for (; blocks; blocks--, data += 64) {
+        __m128i abef = state0, cdgh = state1;
+        __m128i msg[4];     // msg[g % 4] = W[4g .. 4g + 3]
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), mask);
+        }
+
+        // 완전히 펼쳐 msg[]가 레지스터에 남도록
+#pragma GCC unroll 16
+        for (int g = 0; g < 16; g++) {
+            __m128i wk = _mm_add_epi32(msg[g & 3],
+                                       _mm_loadu_si128((const __m128i*)&sha256_k[4 * g]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0e));
+            if (g < 12) {
+                // 다 쓴 묶음 자리에 W[4(g + 4) ..] 계산
+                __m128i w = _mm_sha256msg1_epu32(msg[g & 3], msg[(g + 1) & 3]);
+                w = _mm_add_epi32(w, _mm_alignr_epi8(msg[(g + 3) & 3], msg[(g + 2) & 3], 4));
+                msg[g & 3] = _mm_sha256msg2_epu32(w, msg[(g + 3) & 3]);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);                  // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1);               // DCHG
+    _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(tmp, state1, 0xf0));  // DCBA
+    _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(state1, tmp, 8));     // HGFE
+}
+#endif
+
+static void (*sha256_blocks)(uint32_t state[8], const unsigned char *data, size_t blocks);
+
+// 압축 함수 선택 (처음 사용할 때 한 번, 여러 스레드가 동시에 골라도 같은 값)
+static void sha256_select(void) {
+    void (*blocks)(uint32_t*, const unsigned char*, size_t) = sha256_blocks_portable;
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_1) &&
+        __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA)) {
+        blocks = sha256_blocks_ni;
+    }
+#endif
+    sha256_blocks = blocks;
+}
+
+const char* sha256_impl_name(void) {
+    if (!sha256_blocks) sha256_select();
+    return sha256_blocks == sha256_blocks_portable ? "portable" : "sha-ni";
+}
+
+void sha256_init(Sha256 *ctx) {
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->length = 0;
+    if (!sha256_blocks) sha256_select();
+}
+
+void sha256_update(Sha256 *ctx, const void *data, size_t len) {
+    const unsigned char *p = data;
+    size_t used = ctx->length % 64;
+    ctx->length += len;
+
+    if (used) {
+        size_t n = 64 - used < len ? 64 - used : len;
+        memcpy(ctx->buffer + used, p, n);
+        p += n;
+        len -= n;
+        if (used + n < 64) {
+            return;
+        }
+        sha256_blocks(ctx->state, ctx->buffer, 1);
+    }
+    sha256_blocks(ctx->state, p, len / 64);
+    p += len & ~(size_t)63;
+    memcpy(ctx->buffer, p, len % 64);
+}
+
+void sha256_final(Sha256 *ctx, unsigned char digest[SHA256_DIGEST_LEN]) {
+    uint64_t bits = ctx->length * 8;
+    size_t used = ctx->length % 64;
+
+    // 패딩: 0x80, 0으로 채워 56바이트를 맞춘 뒤 비트 길이 (빅 엔디언)
+    ctx->buffer[used++] = 0x80;
+    if (used > 56) {
+        memset(ctx->buffer + used, 0, 64 - used);
+        sha256_blocks(ctx->state, ctx->buffer, 1);
+        used = 0;
+    }
+    memset(ctx->buffer + used, 0, 56 - used);
+    for (int i = 0; i < 8; i++) {
+        ctx->buffer[56 + i] = (unsigned char)(bits >> (56 - 8 * i));
+    }
+    sha256_blocks(ctx->state, ctx->buffer, 1);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (unsigned char)(ctx->state[i] >> 24);
+        digest[i * 4 + 1] = (unsigned char)(ctx->state[i] >> 16);
+        digest[i * 4 + 2] = (unsigned char)(ctx->state[i] >> 8);
+        digest[i * 4 + 3] = (unsigned char)ctx->state[i];
+    }
+}
+
+// 한 번에 해시
+void sha256(const void *data, size_t len, unsigned char digest[SHA256_DIGEST_LEN]) {
+    Sha256 ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, len);
+    sha256_final(&ctx, digest);
+}
@@ -14,9 +14,7 @@ void signal_handler(int signo) {
 
             // 공유 메모리에 종료 플래그 설정
             if (shared_data) {
-                pthread_mutex_lock(&shared_data->mutex);
-                shared_data->shutdown_flag = 1;
-                pthread_mutex_unlock(&shared_data->mutex);
+                atomic_store(&shared_data->shutdown_flag, 1);
             }
 
             // 모든 워커에게 SIGTERM 전송
@@ -77,6 +75,33 @@ void sigchld_handler(int signo) {
     }
 }
 
+// 스레드 엔진(-T)의 SIGINT / SIGTERM: 종료 플래그만 세움 (핸들러 안에서는 비동기 안전 함수만)
+// 스레드는 다음 청크를 가져가기 전에 플래그를 보고 멈추고, main이 진행 기록을 닫고 재개를 안내
+static void stop_handler(int signo) {
+    (void)signo;
+    static const char msg[] = "\n[Master] Interrupted, stopping after current chunks...\n";
+    if (shared_data) {
+        atomic_store(&shared_data->shutdown_flag, 1);
+    }
+    ssize_t written = write(STDOUT_FILENO, msg, sizeof(msg) - 1);
+    (void)written;
+}
+
+// signal_handler의 SIGINT / SIGTERM 대신 stop_handler 설정
+// (SA_RESETHAND: 두 번째 Ctrl+C는 기다리지 않고 기본 동작으로 종료)
+void setup_stop_handlers(void) {
+    struct sigaction sa;
+    sa.sa_handler = stop_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESETHAND;
+    if (sigaction(SIGINT, &sa, NULL) == -1) {
+        perror("sigaction SIGINT");
+    }
+    if (sigaction(SIGTERM, &sa, NULL) == -1) {
+        perror("sigaction SIGTERM");
+    }
+}
+
 // 시그널 핸들러 설정 (교안 ch08 기반)
 void setup_signal_handlers(void) {
     struct sigaction sa;
@@ -102,6 +127,12 @@ void setup_signal_handlers(void) {
         perror("sigaction SIGTERM");
     }
 
+    // SIGPIPE 무시: 워커가 죽은 파이프에 쓰면 프로세스 종료 대신 EPIPE로 처리
+    sa.sa_handler = SIG_IGN;
+    if (sigaction(SIGPIPE, &sa, NULL) == -1) {
+        perror("sigaction SIGPIPE");
+    }
+
     // SIGCHLD 핸들러
     sa.sa_handler = sigchld_handler;
     sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
@@ -0,0 +1,275 @@
+#include "crypto_system.h"
+
+// 스트리밍 모드 (-e - / -d -)
+//
+// 표준 입력은 크기를 알 수 없고 되돌아 읽을 수 없으므로 파일 매핑 대신 버퍼 고리를 쓴다.
+// 읽기(호출 스레드), 변환(작업 스레드 여러 개), 쓰기(쓰기 스레드)가 서로 다른 버퍼에서
+// 동시에 진행되고, 쓰기 스레드는 읽은 순서(sequence)대로만 내보내므로 출력 순서가 유지된다.
+// 버퍼마다 스트림 시작부터의 오프셋을 기록해 xor_transform에 넘기므로
+// 버퍼 경계가 어디에 오든 키 위상이 파일 모드와 같다.
+//
+// 버퍼 상태: FREE → (읽기) FILLED → (변환) READY → (쓰기) FREE
+// sequence 번호 n인 버퍼는 항상 고리의 n % count 번째 칸을 사용한다.
+
+enum { SLOT_FREE, SLOT_FILLED, SLOT_BUSY, SLOT_READY };
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    uint64_t offset;        // 스트림 시작부터의 위치 (키 위상)
+    int state;
+} StreamSlot;
+
+typedef struct {
+    const KeyStream *ks;
+    int out_fd;
+    StreamSlot slots[STREAM_MAX_BUFFERS];
+    int count;
+    uint64_t next_read;         // 다음에 채울 sequence
+    uint64_t next_transform;    // 다음에 변환할 sequence
+    uint64_t next_write;        // 다음에 내보낼 sequence
+    int eof;                    // 읽기 끝 (next_read가 전체 버퍼 수)
+    int failed;
+    uint64_t bytes_out;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;     // 상태가 바뀔 때마다 broadcast
+} StreamRing;
+
+// 오류: 모든 스레드가 기다리지 않고 빠져나가게 함
+static void ring_fail(StreamRing *ring) {
+    pthread_mutex_lock(&ring->lock);
+    ring->failed = 1;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+// 변환 스레드: 읽힌 버퍼를 순서와 무관하게 가져가 제자리에서 변환
+static void* stream_transform_func(void *arg) {
+    StreamRing *ring = (StreamRing*)arg;
+
+    pthread_mutex_lock(&ring->lock);
+    while (1) {
+        while (!ring->failed && !ring->eof && ring->next_transform >= ring->next_read) {
+            pthread_cond_wait(&ring->changed, &ring->lock);
+        }
+        if (ring->failed || ring->next_transform >= ring->next_read) {
+            break;  // 오류 또는 읽기가 끝났고 남은 버퍼 없음
+        }
+
+        StreamSlot *slot = &ring->slots[ring->next_transform % ring->count];
+        ring->next_transform++;
+        slot->state = SLOT_BUSY;
+        pthread_mutex_unlock(&ring->lock);
+
+        xor_transform(ring->ks, slot->data, slot->data, slot->len, slot->offset);
+
+        pthread_mutex_lock(&ring->lock);
+        slot->state = SLOT_READY;
+        pthread_cond_broadcast(&ring->changed);
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return NULL;
+}
+
+// 쓰기 스레드: sequence 순서대로 내보내고 버퍼를 반납
+static void* stream_write_func(void *arg) {
+    StreamRing *ring = (StreamRing*)arg;
+
+    while (1) {
+        pthread_mutex_lock(&ring->lock);
+        StreamSlot *slot = &ring->slots[ring->next_write % ring->count];
+        while (!ring->failed && !(ring->eof && ring->next_write >= ring->next_read) &&
+               !(ring->next_write < ring->next_read && slot->state == SLOT_READY)) {
+            pthread_cond_wait(&ring->changed, &ring->lock);
+        }
+        int done = ring->failed || ring->next_write >= ring->next_read;
+        pthread_mutex_unlock(&ring->lock);
+        if (done) {
+            break;
+        }
+
+        if (write_full(ring->out_fd, slot->data, slot->len) == -1) {
+            perror("write (stream output)");
+            ring_fail(ring);
+            break;
+        }
+        ring->bytes_out += slot->len;
+
+        pthread_mutex_lock(&ring->lock);
+        ring->next_write++;
+        slot->state = SLOT_FREE;
+        pthread_cond_broadcast(&ring->changed);
+        pthread_mutex_unlock(&ring->lock);
+    }
+    return NULL;
+}
+
+// 스트림 출력 준비 (옵션 처리 직후 main에서 호출)
+// 출력이 표준 출력이면 데이터용으로 복제해 두고, 이후 printf 진행 메시지는
+// 표준 에러로 가도록 표준 출력을 바꿈 (데이터와 섞이지 않음)
+int stream_open_output(const char *output_file) {
+    if (output_file && strcmp(output_file, "-") != 0) {
+        int fd = open(output_file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            perror("open (stream output)");
+        }
+        return fd;
+    }
+
+    fflush(stdout);
+    int fd = dup(STDOUT_FILENO);
+    if (fd == -1 || dup2(STDERR_FILENO, STDOUT_FILENO) == -1) {
+        perror("dup (stream output)");
+        if (fd != -1) close(fd);
+        return -1;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);   // 표준 에러의 오류 메시지와 순서 유지
+    return fd;
+}
+
+// 표준 입력 → out_fd 스트리밍 변환 (변환 스레드 num_threads개)
+int process_stream(int out_fd, int num_threads, char mode, const char *key) {
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    printf("\n=== Crypto System (Streaming Mode) ===\n");
+    printf("Input: stdin\n");
+    printf("Mode: %s\n", mode == 'e' ? "Encryption" : "Decryption");
+    printf("Threads: %d\n", num_threads);
+
+    KeyStream ks;
+    if (keystream_init(&ks, key) == -1) {
+        close(out_fd);
+        return -1;
+    }
+
+    // 변환 스레드마다 버퍼 두 개 + 읽기 / 쓰기 중인 버퍼
+    StreamRing ring = { 0 };
+    ring.ks = &ks;
+    ring.out_fd = out_fd;
+    ring.count = num_threads * 2 + 2;
+    if (ring.count > STREAM_MAX_BUFFERS) ring.count = STREAM_MAX_BUFFERS;
+    pthread_mutex_init(&ring.lock, NULL);
+    pthread_cond_init(&ring.changed, NULL);
+
+    size_t area_size = (size_t)ring.count * STREAM_BUF_SIZE;
+    unsigned char *area = mmap(NULL, area_size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED) {
+        perror("mmap stream buffers");
+        close(out_fd);
+        return -1;
+    }
+    for (int i = 0; i < ring.count; i++) {
+        ring.slots[i].data = area + (size_t)i * STREAM_BUF_SIZE;
+        ring.slots[i].state = SLOT_FREE;
+    }
+    printf("Buffers: %d x %.2f MB\n\n", ring.count, STREAM_BUF_SIZE / 1024.0 / 1024.0);
+
+    pthread_t writer;
+    pthread_t threads[MAX_WORKERS];
+    int started = 0;
+    int err = pthread_create(&writer, NULL, stream_write_func, &ring);
+    if (err != 0) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(err));
+        munmap(area, area_size);
+        close(out_fd);
+        return -1;
+    }
+    for (int i = 0; i < num_threads; i++) {
+        err = pthread_create(&threads[i], NULL, stream_transform_func, &ring);
+        if (err != 0) {
+            // 이미 시작된 스레드들이 모든 버퍼를 변환하므로 계속 진행
+            fprintf(stderr, "pthread_create: %s (continuing with %d threads)\n",
+                    strerror(err), started);
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        ring_fail(&ring);
+    }
+
+    // 읽기: 빈 버퍼를 기다렸다가 가득 채움 (파이프는 짧게 읽히므로 read_full)
+    uint64_t offset = 0;
+    while (1) {
+        pthread_mutex_lock(&ring.lock);
+        StreamSlot *slot = &ring.slots[ring.next_read % ring.count];
+        while (!ring.failed && slot->state != SLOT_FREE) {
+            pthread_cond_wait(&ring.changed, &ring.lock);
+        }
+        int failed = ring.failed;
+        pthread_mutex_unlock(&ring.lock);
+        if (failed) {
+            break;
+        }
+
+        ssize_t n = read_full(STDIN_FILENO, slot->data, STREAM_BUF_SIZE);
+        if (n == -1) {
+            perror("read (stdin)");
+            ring_fail(&ring);
+            break;
+        }
+
+        pthread_mutex_lock(&ring.lock);
+        if (n > 0) {
+            slot->len = n;
+            slot->offset = offset;
+            slot->state = SLOT_FILLED;
+            ring.next_read++;
+            offset += n;
+        }
+        if ((size_t)n < STREAM_BUF_SIZE) {
+            ring.eof = 1;
+        }
+        pthread_cond_broadcast(&ring.changed);
+        pthread_mutex_unlock(&ring.lock);
+        if ((size_t)n < STREAM_BUF_SIZE) {
+            break;
+        }
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_join(writer, NULL);
+
+    int result = ring.failed ? -1 : 0;
+    if (result == 0 && ring.bytes_out != offset) {
+        fprintf(stderr, "Error: Wrote %llu of %llu bytes\n",
+                (unsigned long long)ring.bytes_out, (unsigned long long)offset);
+        result = -1;
+    }
+
+    // 출력이 일반 파일이면 정책에 따라 한 번 동기화 (파이프는 해당 없음)
+    struct stat statbuf;
+    if (result == 0 && durability_mode != DURABILITY_NONE &&
+        fstat(out_fd, &statbuf) == 0 && S_ISREG(statbuf.st_mode) &&
+        fdatasync(out_fd) == -1) {
+        perror("fdatasync");
+        result = -1;
+    }
+
+    munmap(area, area_size);
+    close(out_fd);
+    pthread_cond_destroy(&ring.changed);
+    pthread_mutex_destroy(&ring.lock);
+    if (result == -1) {
+        return -1;
+    }
+
+    gettimeofday(&end, NULL);
+
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_usec - start.tv_usec) / 1000000.0;
+    double mb_size = offset / (1024.0 * 1024.0);
+
+    printf("\n=== Performance Statistics ===\n");
+    printf("Stream size: %.2f MB\n", mb_size);
+    printf("Processing time: %.3f seconds\n", elapsed);
+    printf("Throughput: %.2f MB/s\n", elapsed > 0 ? mb_size / elapsed : 0.0);
+    printf("Threads: %d\n", started);
+    printf("==============================\n");
+
+    return 0;
+}
@@ -26,6 +26,9 @@ void print_system_info(void) {
         printf("Available CPUs: %ld\n", num_cpus);
     }
 
+    // NUMA 토폴로지 (sysfs)
+    print_numa_topology();
+
     printf("==========================\n\n");
 }
 
@@ -44,3 +47,18 @@ void print_performance_stats(struct timeval *start, struct timeval *end,
     printf("Throughput: %.2f MB/s\n", throughput);
     printf("==============================\n");
 }
+
+// 페이지 폴트 통계 출력 (이 프로세스 + 회수된 워커 프로세스)
+void print_fault_stats(size_t bytes) {
+    struct rusage self, children;
+    if (getrusage(RUSAGE_SELF, &self) == -1 ||
+        getrusage(RUSAGE_CHILDREN, &children) == -1) {
+        return;
+    }
+
+    long minor = self.ru_minflt + children.ru_minflt;
+    long major = self.ru_majflt + children.ru_majflt;
+    double mb = bytes / (1024.0 * 1024.0);
+    printf("Page faults: %ld minor, %ld major (%.1f per MB)\n",
+           minor, major, mb > 0 ? (minor + major) / mb : 0.0);
+}
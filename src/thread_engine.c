@@ -0,0 +1,306 @@
+#include "crypto_system.h"
+
+extern SharedData *shared_data;
+
+// 스레드 기반 실행 엔진 (교안 ch11 기반)
+// 프로세스 모델과 같은 청크 작업(transform_chunk)을 한 프로세스 안의 pthread 풀에서 실행한다.
+// 파일은 한 번만 매핑하고 모든 스레드가 공유하므로 fork, 워커별 전체 매핑,
+// 파이프 메시지 비용이 없다. 청크 배분과 진행 상황은 프로세스 모델과 같은
+// SharedData 카운터(next_chunk 커서, 워커별 슬롯)를 사용한다.
+// direct I/O(-O)에서는 매핑 대신 파일을 한 번 열고 스레드들이 버퍼 풀을 함께 쓴다.
+
+// 스레드 간 공유 작업 정보
+typedef struct {
+    SharedData *shared;
+    const KeyStream *ks;
+    const unsigned char *src;   // 데이터 시작 (컨테이너는 헤더 뒤)
+    unsigned char *dst;
+    off_t out_data;             // 출력 파일에서 데이터 시작 위치 (write-behind용)
+    size_t file_size;
+    size_t chunk_size;
+    int num_chunks;
+    Journal *journal;
+    DirectPool *pool;           // direct I/O 버퍼 풀 (mmap 경로는 NULL)
+    const DirectFiles *direct;
+    int sync_fd;                // write-behind용 출력 fd (그 외 -1)
+    const FileLayout *layout;   // 청크 체크섬 기록 / 검증 (layout_chunk_done)
+    atomic_int errors;
+} ThreadJob;
+
+// 스레드별 인자
+typedef struct {
+    int thread_id;
+    int chunks_done;
+    ThreadJob *job;
+} ThreadArg;
+
+// 작업 스레드: 공유 커서에서 청크를 가져와 처리
+static void* engine_thread_func(void *arg) {
+    ThreadArg *targ = (ThreadArg*)arg;
+    ThreadJob *job = targ->job;
+    SharedData *shared = job->shared;
+    int chunk_id;
+
+    affinity_apply(targ->thread_id);
+
+    while ((chunk_id = atomic_fetch_add(&shared->next_chunk, 1)) < job->num_chunks) {
+        if (atomic_load(&shared->shutdown_flag)) {
+            break;
+        }
+        if (!layout_chunk_pending(job->layout, chunk_id)) {
+            continue;   // 재개: 이전 실행에서 완료된 청크
+        }
+
+        off_t offset = (off_t)chunk_id * job->chunk_size;
+        size_t size = job->file_size - offset < job->chunk_size ?
+                      job->file_size - offset : job->chunk_size;
+
+        WorkerSlot *slot = &shared->workers[targ->thread_id];
+        atomic_store_explicit(&slot->status, STATUS_WORKING, memory_order_relaxed);
+
+        ChunkChecksum checksum;
+        chunk_checksum_init(&checksum, job->layout->checksum, chunk_id);
+        ChunkChecksum *sum = checksum.side != CHECKSUM_NONE ? &checksum : NULL;
+        int result;
+        if (job->pool) {
+            result = direct_transform_chunk(job->pool, job->ks, job->direct,
+                                            job->file_size, offset, size, sum,
+                                            shared, targ->thread_id);
+        } else {
+            result = transform_chunk(job->ks, job->src, job->dst, job->file_size,
+                                     offset, size, chunk_id, job->journal,
+                                     job->sync_fd, job->out_data, sum,
+                                     shared, targ->thread_id);
+        }
+        if (result == 0) {
+            result = layout_chunk_done(job->layout, chunk_id, checksum.value);
+        }
+
+        atomic_store_explicit(&slot->status, result == 0 ? STATUS_DONE : STATUS_ERROR,
+                              memory_order_relaxed);
+
+        if (result == 0) {
+            atomic_fetch_add_explicit(&slot->chunks_done, 1, memory_order_release);
+            targ->chunks_done++;
+        } else {
+            fprintf(stderr, "[Thread %d] Error on chunk %d\n", targ->thread_id, chunk_id);
+            atomic_fetch_add(&job->errors, 1);
+        }
+    }
+
+    return NULL;
+}
+
+// 멀티스레드 파일 처리
+int process_single_file_threaded(const char *input_file, const char *output_file,
+                                 int num_threads, char mode, const char *key,
+                                 int in_place, size_t chunk_size,
+                                 const FileLayout *layout) {
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    printf("\n=== Crypto System (Multi-Thread Mode) ===\n");
+    printf("Input file: %s\n", input_file);
+    printf("Output file: %s\n", output_file);
+    printf("Mode: %s%s\n", mode == 'e' ? "Encryption" : "Decryption",
+           in_place ? " (in-place)" : "");
+    printf("Process ID: %d\n", getpid());
+    printf("Threads: %d\n", num_threads);
+
+    // 데이터 크기 (파일 검증은 layout_prepare에서 완료, 컨테이너는 헤더의 원본 크기)
+    size_t file_size = layout->data_size;
+    if (file_size == 0) {
+        fprintf(stderr, "Error: File is empty or invalid\n");
+        return -1;
+    }
+
+    printf("File size: %.2f MB\n\n", file_size / 1024.0 / 1024.0);
+
+    KeyStream ks;
+    if (keystream_init(&ks, key) == -1) {
+        return -1;
+    }
+
+    // 출력 파일 생성 (제자리 모드는 생략)
+    if (!in_place && layout_create_output(layout, output_file) == -1) {
+        fprintf(stderr, "Error: Failed to create output file\n");
+        return -1;
+    }
+
+    // direct I/O: 파일을 한 번 열고 스레드 수만큼의 버퍼 풀을 공유
+    int direct = use_direct_io && !in_place;
+    DirectFiles files = { .in_fd = -1, .out_fd = -1 };
+    DirectPool *pool = NULL;
+    if (direct) {
+        pool = direct_pool_create(num_threads);
+        if (!pool || direct_open(&files, input_file, output_file) == -1) {
+            direct_pool_destroy(pool);
+            return -1;
+        }
+        files.in_data = layout->in_data;
+        files.out_data = layout->out_data;
+    }
+
+    // 파일은 프로세스 전체에서 한 번만 매핑 (컨테이너는 헤더와 인덱스 포함 전체)
+    size_t src_size = 0, dst_size = 0;
+    unsigned char *src_data = NULL;
+    if (!direct) {
+        src_data = map_file_to_memory(input_file, &src_size, in_place);
+        if (!src_data) {
+            fprintf(stderr, "Error: Failed to map input file to memory\n");
+            return -1;
+        }
+    }
+
+    unsigned char *dst_data = src_data;
+    dst_size = src_size;
+    if (!in_place && !direct) {
+        dst_data = map_file_to_memory(output_file, &dst_size, 1);
+        if (!dst_data) {
+            fprintf(stderr, "Error: Failed to map output file to memory\n");
+            unmap_file(src_data, src_size);
+            return -1;
+        }
+    }
+
+    // 진행 상황 카운터 (프로세스 모델과 같은 구조 사용)
+    SharedData *shared = init_shared_memory();
+    if (!shared) {
+        if (direct) {
+            direct_close(&files);
+            direct_pool_destroy(pool);
+        } else {
+            unmap_file(src_data, src_size);
+            if (!in_place) unmap_file(dst_data, dst_size);
+        }
+        return -1;
+    }
+
+    // 청크 계산 (컨테이너와 진행 기록은 정해 둔 청크 크기를 그대로 사용)
+    chunk_size = choose_chunk_size(file_size, num_threads,
+                                   layout->chunk_size ? layout->chunk_size : chunk_size);
+    int num_chunks = (file_size + chunk_size - 1) / chunk_size;
+    shared_reset(shared, num_chunks - layout->resumed_chunks,
+                 file_size - layout->resumed_bytes);
+    shared_data = shared;   // Ctrl+C가 종료 플래그를 세울 곳 (setup_stop_handlers)
+
+    // 제자리 모드: 변환 전에 저널 생성
+    Journal journal = { .fd = -1 };
+    if (in_place && journal_create(&journal, input_file, mode, file_size,
+                                   chunk_size, num_chunks) == -1) {
+        cleanup_shared_memory(shared);
+        unmap_file(src_data, src_size);
+        return -1;
+    }
+
+    ThreadJob job = {
+        .shared = shared,
+        .ks = &ks,
+        .src = direct ? NULL : src_data + layout->in_data,
+        .dst = direct ? NULL : dst_data + layout->out_data,
+        .out_data = layout->out_data,
+        .file_size = file_size,
+        .chunk_size = chunk_size,
+        .num_chunks = num_chunks,
+        .journal = in_place ? &journal : NULL,
+        .pool = pool,
+        .direct = &files,
+        .sync_fd = in_place || direct ? -1 : durability_open(output_file),
+        .layout = layout,
+    };
+    atomic_init(&job.errors, 0);
+
+    printf("=== Scheduling %d chunks of %.2f MB across %d threads ===\n",
+           num_chunks, chunk_size / 1024.0 / 1024.0, num_threads);
+
+    pthread_t threads[MAX_WORKERS];
+    ThreadArg args[MAX_WORKERS];
+    int started = 0;
+    for (int i = 0; i < num_threads; i++) {
+        args[i].thread_id = i;
+        args[i].chunks_done = 0;
+        args[i].job = &job;
+
+        int err = pthread_create(&threads[i], NULL, engine_thread_func, &args[i]);
+        if (err != 0) {
+            // 이미 시작된 스레드들이 남은 청크를 가져가므로 계속 진행
+            fprintf(stderr, "pthread_create: %s (continuing with %d threads)\n",
+                    strerror(err), started);
+            break;
+        }
+        started++;
+    }
+
+    // 스레드 종료 대기
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        printf("[Master] Thread %d completed %d chunks\n", i, args[i].chunks_done);
+    }
+
+    int errors = atomic_load(&job.errors);
+    int completed = shared_completed_chunks(shared) + layout->resumed_chunks;
+    if (errors == 0 && completed != num_chunks) {
+        if (atomic_load(&shared->shutdown_flag)) {
+            fprintf(stderr, "Interrupted: %d of %d chunks completed\n", completed, num_chunks);
+        } else {
+            fprintf(stderr, "Error: Only %d of %d chunks completed\n",
+                    completed, num_chunks);
+        }
+        errors++;
+    }
+    if (job.sync_fd != -1) {
+        close(job.sync_fd);
+    }
+
+    shared_data = NULL;
+    cleanup_shared_memory(shared);
+    if (direct) {
+        direct_close(&files);
+        direct_pool_destroy(pool);
+    } else {
+        unmap_file(src_data, src_size);
+        if (!in_place) unmap_file(dst_data, dst_size);
+    }
+
+    // 컨테이너 인덱스 기록, fdatasync / writebehind 정책: 완료를 알리기 전에 출력 전체 동기화
+    if (errors == 0 && (layout_finish(layout, output_file) == -1 ||
+                        durability_finish(output_file) == -1)) {
+        errors++;
+    }
+
+    // 제자리 모드: 모든 청크가 완료된 경우에만 저널 삭제
+    if (in_place) {
+        if (errors == 0) {
+            journal_remove(&journal);
+        } else {
+            journal_close(&journal);
+            fprintf(stderr, "Error: In-place run incomplete, see %s.journal\n",
+                    input_file);
+        }
+    }
+
+    if (errors != 0) {
+        return -1;
+    }
+
+    gettimeofday(&end, NULL);
+
+    printf("\n=== Processing Complete ===\n");
+    printf("Output file: %s\n", output_file);
+
+    // 성능 통계 출력
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_usec - start.tv_usec) / 1000000.0;
+    double mb_size = file_size / (1024.0 * 1024.0);
+    double throughput = mb_size / elapsed;
+
+    printf("\n=== Performance Statistics ===\n");
+    printf("File size: %.2f MB\n", mb_size);
+    printf("Processing time: %.3f seconds\n", elapsed);
+    printf("Throughput: %.2f MB/s\n", throughput);
+    print_fault_stats(file_size);
+    printf("Threads: %d\n", num_threads);
+    printf("==============================\n");
+
+    return 0;
+}
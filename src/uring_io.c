@@ -0,0 +1,624 @@
+#define _GNU_SOURCE     // sync_file_range 플래그
+#include "crypto_system.h"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <poll.h>
+
+// io_uring I/O 백엔드 (-U)
+//
+// mmap 경로는 페이지 폴트와 msync(MS_SYNC)에서 워커가 멈추고 그동안 다른 I/O가 없다.
+// 이 백엔드는 워커마다 고정 버퍼(IORING_REGISTER_BUFFERS) URING_BUFFERS개를 두고
+// 블록 단위로 "읽기 → XOR → 쓰기"를 파이프라인으로 돌린다. 여러 블록의 읽기/쓰기가
+// 동시에 진행되는 동안 이미 읽힌 버퍼를 XOR 커널이 처리한다.
+// 디렉터리 모드에서는 워커가 작업을 최대 URING_MAX_TASKS개까지 받아 두고
+// 여러 파일의 읽기/쓰기를 한 번의 io_uring_enter로 함께 제출한다.
+// 청크가 끝나면 해당 범위를 fsync(datasync)해 mmap 경로의 msync와 같은 내구성을 보장한다
+// (--durability에 따라 생략하거나 sync_file_range로 기록만 시작).
+//
+// liburing 없이 시스템 콜로 직접 링을 구성하며, 커널이 io_uring을 지원하지 않으면
+// (ENOSYS, EPERM 등) 마스터와 워커 모두 기존 mmap 경로로 돌아간다.
+
+int use_io_uring = 0;   // -U (fork 전에 main에서 설정)
+
+#define URING_BLOCK_SIZE (1024 * 1024)  // 고정 버퍼 하나 크기
+#define URING_BUFFERS 8                 // 워커당 동시에 진행되는 블록 수
+#define URING_ENTRIES 32                // 제출 큐 크기 (버퍼당 연산 1개 + fsync)
+#define URING_MAX_CHUNKS (URING_BUFFERS + URING_MAX_TASKS)
+
+// user_data: 하위 2비트는 연산 종류, 나머지는 버퍼/청크 번호
+#define OP_READ 0
+#define OP_WRITE 1
+#define OP_FSYNC 2
+
+// 시스템 콜로 구성한 링
+typedef struct {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned to_submit;     // 큐에 넣었지만 아직 제출하지 않은 연산 수
+    unsigned in_flight;     // 제출했지만 완료되지 않은 연산 수
+} URing;
+
+typedef struct UTask UTask;
+
+// 처리 중인 청크 (보고 단위)
+typedef struct {
+    UTask *task;
+    int chunk_id;
+    off_t next;             // 다음에 읽을 오프셋
+    off_t start, end;
+    int inflight;           // 진행 중인 블록과 fsync 수
+    int synced;             // fsync 제출 여부
+    int failed;
+    int in_use;
+} UChunk;
+
+// 받은 작업
+struct UTask {
+    WorkTask task;
+    int in_fd, out_fd;
+    UChunk *current;        // 읽기를 내보내는 중인 청크
+    int started;            // TASK_RUN: 청크를 시작했는지
+    int exhausted;          // 더 시작할 청크 없음
+    int open_chunks;        // 시작했지만 끝나지 않은 청크 수
+    int failed;
+};
+
+// 고정 버퍼 하나
+typedef struct {
+    unsigned char *data;
+    UChunk *chunk;
+    off_t offset;           // 파일 오프셋
+    size_t len;             // 블록 크기
+    size_t done;            // 현재 연산에서 처리된 바이트 (짧은 읽기/쓰기 이어서 처리)
+    int in_use;
+} UBuffer;
+
+// 워커별 파이프라인 상태
+typedef struct {
+    URing ring;
+    UBuffer buffers[URING_BUFFERS];
+    UChunk chunks[URING_MAX_CHUNKS];
+    UTask tasks[URING_MAX_TASKS];   // 받은 순서대로 (원형 큐)
+    int task_head;
+    int task_count;
+    WorkTask pending;               // 키가 달라 앞의 작업들이 끝나기를 기다리는 작업
+    int has_pending;
+    KeyStream ks;
+    char ks_key[sizeof(((WorkTask*)0)->key)];
+    int worker_id;
+    int write_fd;
+    SharedData *shared;
+    int chunks_done;
+} UPipeline;
+
+// ----- 링 구성과 제출 -----
+
+static int uring_setup(URing *r, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+
+    r->fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) {
+        return -1;
+    }
+    r->entries = p.sq_entries;
+
+    r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cq_ring_size > r->sq_ring_size) r->sq_ring_size = r->cq_ring_size;
+        r->cq_ring_size = r->sq_ring_size;
+    }
+
+    r->sq_ring = mmap(NULL, r->sq_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (r->sq_ring == MAP_FAILED) {
+        close(r->fd);
+        return -1;
+    }
+
+    r->cq_ring = r->sq_ring;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        r->cq_ring = mmap(NULL, r->cq_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if (r->cq_ring == MAP_FAILED) {
+            munmap(r->sq_ring, r->sq_ring_size);
+            close(r->fd);
+            return -1;
+        }
+    }
+
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        if (r->cq_ring != r->sq_ring) munmap(r->cq_ring, r->cq_ring_size);
+        munmap(r->sq_ring, r->sq_ring_size);
+        close(r->fd);
+        return -1;
+    }
+
+    char *sq = r->sq_ring, *cq = r->cq_ring;
+    r->sq_head = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+static void uring_teardown(URing *r) {
+    munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring != r->sq_ring) munmap(r->cq_ring, r->cq_ring_size);
+    munmap(r->sq_ring, r->sq_ring_size);
+    close(r->fd);
+}
+
+// 제출 큐 엔트리 하나 확보 (커널이 tail을 읽기 전에 내용을 채움)
+static struct io_uring_sqe* uring_get_sqe(URing *r) {
+    unsigned tail = *r->sq_tail;
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= r->entries) {
+        return NULL;
+    }
+
+    unsigned index = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[index] = index;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    r->to_submit++;
+    r->in_flight++;
+    return sqe;
+}
+
+// 쌓인 연산 제출 후 완료가 wait_nr개 이상 될 때까지 대기
+static int uring_submit_and_wait(URing *r, unsigned wait_nr) {
+    while (1) {
+        int ret = syscall(__NR_io_uring_enter, r->fd, r->to_submit, wait_nr,
+                          wait_nr ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (ret >= 0) {
+            r->to_submit -= ret;
+            return 0;
+        }
+        if (errno != EINTR) {
+            perror("io_uring_enter");
+            return -1;
+        }
+    }
+}
+
+// 완료 큐에서 하나 꺼내기 (없으면 0)
+static int uring_pop_cqe(URing *r, struct io_uring_cqe *out) {
+    unsigned head = *r->cq_head;
+    if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    *out = r->cqes[head & *r->cq_mask];
+    __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+    r->in_flight--;
+    return 1;
+}
+
+// 커널이 io_uring을 지원하는지 확인 (마스터에서 fork 전에 호출)
+int uring_available(void) {
+    URing ring;
+    if (uring_setup(&ring, 4) == -1) {
+        return 0;
+    }
+    uring_teardown(&ring);
+    return 1;
+}
+
+// ----- 파이프라인 -----
+
+static void pipeline_queue_read(UPipeline *p, UBuffer *b) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&p->ring);
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = b->chunk->task->in_fd;
+    sqe->addr = (uintptr_t)(b->data + b->done);
+    sqe->len = b->len - b->done;
+    sqe->off = b->offset + b->done;
+    sqe->buf_index = b - p->buffers;
+    sqe->user_data = ((b - p->buffers) << 2) | OP_READ;
+}
+
+static void pipeline_queue_write(UPipeline *p, UBuffer *b) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&p->ring);
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = b->chunk->task->out_fd;
+    sqe->addr = (uintptr_t)(b->data + b->done);
+    sqe->len = b->len - b->done;
+    sqe->off = b->offset + b->done;
+    sqe->buf_index = b - p->buffers;
+    sqe->user_data = ((b - p->buffers) << 2) | OP_WRITE;
+}
+
+// 청크 범위만 데이터 동기화 (msync(MS_SYNC)와 같은 vfs_fsync_range)
+// writebehind 정책은 기다리지 않는 sync_file_range로 기록만 시작
+static void pipeline_queue_fsync(UPipeline *p, UChunk *c) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&p->ring);
+    sqe->fd = c->task->out_fd;
+    sqe->off = c->start;
+    sqe->len = c->end - c->start;
+    if (durability_mode == DURABILITY_WRITEBEHIND) {
+        sqe->opcode = IORING_OP_SYNC_FILE_RANGE;
+        sqe->sync_range_flags = SYNC_FILE_RANGE_WRITE;
+    } else {
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    }
+    sqe->user_data = ((c - p->chunks) << 2) | OP_FSYNC;
+}
+
+// 작업 시작: 파일 열기
+static void pipeline_start_task(UPipeline *p, const WorkTask *task) {
+    UTask *t = &p->tasks[(p->task_head + p->task_count) % URING_MAX_TASKS];
+    p->task_count++;
+
+    memset(t, 0, sizeof(*t));
+    t->task = *task;
+    t->in_fd = t->out_fd = -1;
+
+    if (strcmp(p->ks_key, task->key) != 0) {
+        if (keystream_init(&p->ks, task->key) == -1) {
+            t->failed = t->exhausted = 1;
+            return;
+        }
+        memcpy(p->ks_key, task->key, sizeof(p->ks_key));
+    }
+
+    // 제자리 모드는 저널 순서를 지켜야 하므로 mmap 경로에서만 처리
+    if (task->in_place) {
+        fprintf(stderr, "[Worker %d] In-place tasks are not supported by the io_uring backend\n",
+                p->worker_id);
+        t->failed = t->exhausted = 1;
+        return;
+    }
+    // 컨테이너도 mmap 경로에서만 처리 (main이 -U를 끔)
+    if (task->in_data != 0 || task->out_data != 0) {
+        fprintf(stderr, "[Worker %d] Container files are not supported by the io_uring backend\n",
+                p->worker_id);
+        t->failed = t->exhausted = 1;
+        return;
+    }
+
+    t->in_fd = open(task->input_file, O_RDONLY | O_CLOEXEC);
+    t->out_fd = open(task->output_file, O_WRONLY | O_CLOEXEC);
+    if (t->in_fd == -1 || t->out_fd == -1) {
+        fprintf(stderr, "[Worker %d] Cannot open '%s': %s\n", p->worker_id,
+                t->in_fd == -1 ? task->input_file : task->output_file, strerror(errno));
+        t->failed = t->exhausted = 1;
+        return;
+    }
+
+    atomic_store_explicit(&p->shared->workers[p->worker_id].status, STATUS_WORKING,
+                          memory_order_relaxed);
+}
+
+// 작업의 다음 청크 시작 (없으면 NULL)
+static UChunk* pipeline_next_chunk(UPipeline *p, UTask *t) {
+    int chunk_id;
+    off_t start;
+    size_t size;
+
+    if (t->task.type == TASK_RUN) {
+        if (t->started) {
+            t->exhausted = 1;
+            return NULL;
+        }
+        t->started = 1;
+        chunk_id = t->task.chunk_id;
+        start = t->task.offset;
+        size = t->task.size;
+    } else {
+        // 원자적 커서에서 다음 청크 번호를 가져옴 (mmap 경로와 같은 동적 스케줄링)
+        if (atomic_load(&p->shared->shutdown_flag) ||
+            (chunk_id = atomic_fetch_add(&p->shared->next_chunk, 1)) >= t->task.num_chunks) {
+            t->exhausted = 1;
+            return NULL;
+        }
+        start = (off_t)chunk_id * t->task.chunk_size;
+        size = t->task.file_size - start < t->task.chunk_size ?
+               t->task.file_size - start : t->task.chunk_size;
+    }
+
+    for (int i = 0; i < URING_MAX_CHUNKS; i++) {
+        UChunk *c = &p->chunks[i];
+        if (!c->in_use) {
+            memset(c, 0, sizeof(*c));
+            c->in_use = 1;
+            c->task = t;
+            c->chunk_id = chunk_id;
+            c->start = c->next = start;
+            c->end = start + size;
+            t->open_chunks++;
+            return c;
+        }
+    }
+
+    // 청크 슬롯은 버퍼 수 + 작업 수만큼 있으므로 여기에 오지 않음
+    fprintf(stderr, "[Worker %d] Out of chunk slots\n", p->worker_id);
+    t->exhausted = 1;
+    return NULL;
+}
+
+// 청크 완료: 보고 후 슬롯 반환
+static void pipeline_finish_chunk(UPipeline *p, UChunk *c) {
+    UTask *t = c->task;
+    WorkerSlot *slot = &p->shared->workers[p->worker_id];
+
+    if (!c->failed) {
+        atomic_fetch_add_explicit(&slot->chunks_done, 1, memory_order_release);
+        p->chunks_done++;
+    }
+
+    // TASK_JOB은 청크마다 바로 보고, TASK_RUN은 작업 순서대로 (pipeline_retire)
+    if (t->task.type == TASK_JOB) {
+        send_report(p->write_fd, c->chunk_id, c->failed ? STATUS_ERROR : STATUS_DONE, 0);
+    } else if (c->failed) {
+        t->failed = 1;
+    }
+
+    t->open_chunks--;
+    c->in_use = 0;
+}
+
+// 청크의 읽기/쓰기가 모두 끝났으면 동기화 후 완료
+static void pipeline_check_chunk(UPipeline *p, UChunk *c) {
+    if (c->inflight > 0 || c == c->task->current) {
+        return;
+    }
+    if (!c->failed && !c->synced && (durability_mode == DURABILITY_CHUNK ||
+                                     durability_mode == DURABILITY_WRITEBEHIND)) {
+        c->synced = 1;
+        c->inflight++;
+        pipeline_queue_fsync(p, c);
+        return;
+    }
+    pipeline_finish_chunk(p, c);
+}
+
+// 빈 버퍼마다 다음 블록 읽기 제출 (먼저 받은 작업부터)
+static void pipeline_fill(UPipeline *p) {
+    for (int i = 0; i < URING_BUFFERS; i++) {
+        UBuffer *b = &p->buffers[i];
+        if (b->in_use) {
+            continue;
+        }
+
+        UChunk *c = NULL;
+        for (int k = 0; k < p->task_count && !c; k++) {
+            UTask *t = &p->tasks[(p->task_head + k) % URING_MAX_TASKS];
+            while (!t->current && !t->exhausted) {
+                t->current = pipeline_next_chunk(p, t);
+            }
+            c = t->current;
+        }
+        if (!c) {
+            return;  // 모든 작업이 읽기를 다 내보냄
+        }
+
+        b->in_use = 1;
+        b->chunk = c;
+        b->offset = c->next;
+        b->len = c->end - c->next < URING_BLOCK_SIZE ? c->end - c->next : URING_BLOCK_SIZE;
+        b->done = 0;
+        c->next += b->len;
+        c->inflight++;
+        if (c->next == c->end) {
+            c->task->current = NULL;
+        }
+        pipeline_queue_read(p, b);
+    }
+}
+
+// 완료 이벤트 처리
+static void pipeline_complete(UPipeline *p, const struct io_uring_cqe *cqe) {
+    int op = cqe->user_data & 3;
+    int index = cqe->user_data >> 2;
+
+    if (op == OP_FSYNC) {
+        UChunk *c = &p->chunks[index];
+        if (cqe->res < 0) {
+            fprintf(stderr, "[Worker %d] fsync '%s': %s\n", p->worker_id,
+                    c->task->task.output_file, strerror(-cqe->res));
+            c->failed = 1;
+        }
+        c->inflight--;
+        pipeline_check_chunk(p, c);
+        return;
+    }
+
+    UBuffer *b = &p->buffers[index];
+    UChunk *c = b->chunk;
+
+    if (cqe->res <= 0) {
+        // 읽기 도중 EOF(0)는 파일이 줄어든 경우
+        fprintf(stderr, "[Worker %d] %s '%s' at %ld: %s\n", p->worker_id,
+                op == OP_READ ? "read" : "write",
+                op == OP_READ ? c->task->task.input_file : c->task->task.output_file,
+                (long)(b->offset + b->done),
+                cqe->res < 0 ? strerror(-cqe->res) : "unexpected end of file");
+        c->failed = 1;
+        if (c == c->task->current) {
+            c->task->current = NULL;  // 실패한 청크는 더 읽지 않음
+        }
+        b->in_use = 0;
+        c->inflight--;
+        pipeline_check_chunk(p, c);
+        return;
+    }
+
+    // 짧은 읽기/쓰기는 나머지를 이어서 제출
+    b->done += cqe->res;
+    if (b->done < b->len) {
+        if (op == OP_READ) pipeline_queue_read(p, b);
+        else pipeline_queue_write(p, b);
+        return;
+    }
+
+    if (op == OP_READ) {
+        // 읽기 완료: 버퍼에서 바로 변환 후 같은 버퍼로 쓰기
+        xor_transform(&p->ks, b->data, b->data, b->len, b->offset);
+        b->done = 0;
+        pipeline_queue_write(p, b);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&p->shared->workers[p->worker_id].bytes_done,
+                              b->len, memory_order_relaxed);
+    b->in_use = 0;
+    c->inflight--;
+    pipeline_check_chunk(p, c);
+}
+
+// 먼저 받은 작업부터, 끝난 작업을 보고하고 정리 (마스터는 작업 순서대로 보고를 해석)
+static int pipeline_retire(UPipeline *p) {
+    while (p->task_count > 0) {
+        UTask *t = &p->tasks[p->task_head];
+        if (!t->exhausted || t->current || t->open_chunks > 0) {
+            break;
+        }
+
+        if (t->task.type == TASK_RUN &&
+            send_report(p->write_fd, t->task.chunk_id,
+                        t->failed ? STATUS_ERROR : STATUS_DONE, 0) == -1) {
+            return -1;
+        }
+        if (send_report(p->write_fd, -1, STATUS_IDLE, 0) == -1) {
+            return -1;
+        }
+
+        if (t->in_fd != -1) close(t->in_fd);
+        if (t->out_fd != -1) close(t->out_fd);
+        p->task_head = (p->task_head + 1) % URING_MAX_TASKS;
+        p->task_count--;
+    }
+    return 0;
+}
+
+// 작업 받기: 처리 중인 작업이 없으면 블로킹, 있으면 이미 도착한 것만
+// 반환: 0 계속, 1 종료 요청 또는 마스터가 파이프를 닫음
+static int pipeline_accept(UPipeline *p, int read_fd) {
+    while (p->task_count < URING_MAX_TASKS) {
+        if (p->has_pending) {
+            // 키가 다른 작업은 앞의 작업이 모두 끝난 뒤 시작 (키스트림 하나를 공유)
+            if (p->task_count > 0) {
+                return 0;
+            }
+            p->has_pending = 0;
+            pipeline_start_task(p, &p->pending);
+            continue;
+        }
+
+        if (p->task_count > 0) {
+            struct pollfd pfd = { .fd = read_fd, .events = POLLIN };
+            if (poll(&pfd, 1, 0) <= 0) {
+                return 0;
+            }
+        }
+
+        ssize_t n = read_full(read_fd, &p->pending, sizeof(WorkTask));
+        if (n != sizeof(WorkTask)) {
+            if (n == -1) perror("[Worker] read failed");
+            return 1;
+        }
+        if (p->pending.type == TASK_SHUTDOWN) {
+            return 1;
+        }
+        if (p->task_count > 0 && strcmp(p->ks_key, p->pending.key) != 0) {
+            p->has_pending = 1;
+            return 0;
+        }
+        pipeline_start_task(p, &p->pending);
+    }
+    return 0;
+}
+
+// io_uring 워커 루프 (worker_main에서 호출)
+// 링이나 고정 버퍼를 준비할 수 없으면 작업을 받기 전에 -1을 반환 → mmap 경로로 처리
+// 정상 종료 시 처리한 청크 수 반환
+int uring_worker_main(int worker_id, int read_fd, int write_fd, SharedData *shared) {
+    UPipeline *p = calloc(1, sizeof(UPipeline));
+    unsigned char *pool = NULL;
+    if (!p || posix_memalign((void**)&pool, 4096, URING_BUFFERS * URING_BLOCK_SIZE) != 0) {
+        free(p);
+        return -1;
+    }
+
+    if (uring_setup(&p->ring, URING_ENTRIES) == -1) {
+        fprintf(stderr, "[Worker %d] io_uring unavailable (%s), using mmap\n",
+                worker_id, strerror(errno));
+        free(pool);
+        free(p);
+        return -1;
+    }
+
+    struct iovec iov[URING_BUFFERS];
+    for (int i = 0; i < URING_BUFFERS; i++) {
+        p->buffers[i].data = pool + (size_t)i * URING_BLOCK_SIZE;
+        iov[i].iov_base = p->buffers[i].data;
+        iov[i].iov_len = URING_BLOCK_SIZE;
+    }
+    if (syscall(__NR_io_uring_register, p->ring.fd, IORING_REGISTER_BUFFERS,
+                iov, URING_BUFFERS) == -1) {
+        fprintf(stderr, "[Worker %d] io_uring buffer registration failed (%s), using mmap\n",
+                worker_id, strerror(errno));
+        uring_teardown(&p->ring);
+        free(pool);
+        free(p);
+        return -1;
+    }
+
+    p->worker_id = worker_id;
+    p->write_fd = write_fd;
+    p->shared = shared;
+
+    int stopping = 0;
+    while (1) {
+        if (!stopping) {
+            stopping = pipeline_accept(p, read_fd);
+        }
+        if (stopping && p->task_count == 0) {
+            break;
+        }
+
+        pipeline_fill(p);
+        if (pipeline_retire(p) == -1) {
+            break;
+        }
+        if (p->ring.in_flight == 0) {
+            continue;  // 방금 끝난 작업이 있으면 다음 작업을 받음
+        }
+
+        // 여러 작업의 연산을 한 번에 제출하고 하나 이상 완료될 때까지 대기
+        if (uring_submit_and_wait(&p->ring, 1) == -1) {
+            break;
+        }
+        struct io_uring_cqe cqe;
+        while (uring_pop_cqe(&p->ring, &cqe)) {
+            pipeline_complete(p, &cqe);
+        }
+        if (pipeline_retire(p) == -1) {
+            break;
+        }
+    }
+
+    int chunks_done = p->chunks_done;
+    uring_teardown(&p->ring);
+    free(pool);
+    free(p);
+    return chunks_done;
+}
@@ -1,129 +1,637 @@
+#define _GNU_SOURCE     // sync_file_range
 #include "crypto_system.h"
 
-// 워커 프로세스 메인 함수 (교안 ch07, ch10 기반)
-void worker_main(int worker_id, int read_fd, int write_fd,
-                 SharedData *shared, const char *filename) {
-    printf("[Worker %d] Started (PID: %d, PPID: %d)\n",
-           worker_id, getpid(), getppid());
+// 에러 상태 보고
+static void report_error(int write_fd, int chunk_id) {
+    ProgressReport error_report;
+    error_report.chunk_id = chunk_id;
+    error_report.status = STATUS_ERROR;
+    error_report.worker_pid = getpid();
+    error_report.progress = 0.0;
+    error_report.checksum = 0;
+    write_full(write_fd, &error_report, sizeof(ProgressReport));
+}
 
-    // 작업 수신 대기
-    WorkTask task;
-    ssize_t n;
+// 페이지 정렬된 범위 msync (청크 시작이 페이지 경계가 아닐 수 있음)
+static int sync_range(unsigned char *base, off_t offset, size_t size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t sync_start = offset & ~(page_size - 1);
+    return msync(base + sync_start, offset + size - sync_start, MS_SYNC);
+}
 
-    // EINTR 처리 (시그널로 인한 중단 복구)
-    while ((n = read(read_fd, &task, sizeof(WorkTask))) == -1) {
-        if (errno == EINTR) {
-            continue;  // 시그널로 중단되었으면 재시도
-        }
-        perror("[Worker] read failed");
-        exit(1);
+// write-behind: 방금 변환한 블록의 기록을 시작하고, 바로 앞 블록은 기록이 끝날 때까지 대기
+// (더티 페이지가 블록 두 개 이상 쌓이지 않음, 내구성 보장은 마지막 fdatasync가 담당)
+static void write_behind(int fd, off_t offset, size_t size, size_t prev_size) {
+    sync_file_range(fd, offset, size, SYNC_FILE_RANGE_WRITE);
+    if (prev_size > 0) {
+        sync_file_range(fd, offset - prev_size, prev_size,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                        SYNC_FILE_RANGE_WAIT_AFTER);
     }
+}
 
-    if (n != sizeof(WorkTask)) {
-        fprintf(stderr, "[Worker %d] Failed to read task (got %zd bytes, expected %zu)\n",
-                worker_id, n, sizeof(WorkTask));
-        exit(1);
+// 매핑의 [offset, offset + len) 범위에 madvise (페이지 경계로 맞추고 매핑 밖은 자름)
+static void advise_range(const unsigned char *base, size_t map_size,
+                         size_t offset, size_t len, int advice) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t start = offset & ~(page_size - 1);
+    if (start >= map_size) {
+        return;
     }
+    size_t end = offset + len < map_size ? offset + len : map_size;
+    madvise((void*)(base + start), end - start, advice);
+}
 
-    printf("[Worker %d] Received task: chunk_id=%d, offset=%ld, size=%zu, operation=%c\n",
-           worker_id, task.chunk_id, task.offset, task.size, task.operation);
-
-    // 파일 메모리 매핑
-    size_t file_size;
-    void *mapped_data = map_file_to_memory(filename, &file_size, 1);
-    if (!mapped_data) {
-        fprintf(stderr, "[Worker %d] Failed to map file\n", worker_id);
+// 범위의 페이지 테이블을 미리 채움 (MAP_POPULATE를 청크 단위로 적용)
+static void populate_range(const unsigned char *addr, size_t len, int write) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(uintptr_t)(page_size - 1);
+#ifdef MADV_POPULATE_WRITE
+    madvise((void*)start, (uintptr_t)addr + len - start,
+            write ? MADV_POPULATE_WRITE : MADV_POPULATE_READ);
+#else
+    (void)start;
+    (void)write;
+#endif
+}
 
-        // 에러 상태 보고
-        ProgressReport error_report;
-        error_report.chunk_id = task.chunk_id;
-        error_report.status = STATUS_ERROR;
-        error_report.worker_pid = getpid();
-        error_report.progress = 0.0;
-        write(write_fd, &error_report, sizeof(ProgressReport));
+// 청크 크기 결정
+// 지정하지 않으면(0) 워커당 CHUNKS_PER_WORKER개 이상이 되도록 하되
+// CHUNK_MIN_SIZE ~ DEFAULT_CHUNK_SIZE 범위로 제한, 페이지 크기 배수로 맞춤
+size_t choose_chunk_size(size_t file_size, int num_workers, size_t requested) {
+    size_t chunk_size = requested;
 
-        exit(1);
+    if (chunk_size == 0) {
+        chunk_size = file_size / ((size_t)num_workers * CHUNKS_PER_WORKER);
+        if (chunk_size > DEFAULT_CHUNK_SIZE) chunk_size = DEFAULT_CHUNK_SIZE;
+        if (chunk_size < CHUNK_MIN_SIZE) chunk_size = CHUNK_MIN_SIZE;
     }
 
-    // 공유 메모리 업데이트: 작업 시작
-    pthread_mutex_lock(&shared->mutex);
-    shared->worker_status[worker_id] = STATUS_WORKING;
-    pthread_mutex_unlock(&shared->mutex);
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    chunk_size = (chunk_size + page_size - 1) & ~(page_size - 1);
+    return chunk_size;
+}
 
-    // 자신의 청크 암호화/복호화
-    unsigned char *chunk_start = (unsigned char*)mapped_data + task.offset;
+// 매핑된 데이터 범위: src / dst는 데이터 위치 start를 가리킴
+// (단일 프로세스 모드와 스레드 엔진은 데이터 전체를 매핑하므로 start = 0)
+// 데이터 위치는 컨테이너 헤더를 뺀 위치이고, fd로 하는 작업만 in_data / out_data를 더함
+typedef struct {
+    const unsigned char *src;
+    unsigned char *dst;
+    off_t start;
+    size_t size;
+    off_t in_data;      // 입력 / 출력 파일에서 데이터 시작 위치 (FileLayout)
+    off_t out_data;
+    int use_nt;         // 비시간적 저장 사용 여부
+    int prefetch_fd;    // 매핑 밖 다음 블록을 미리 읽을 입력 fd (-1이면 매핑 안에서만)
+} MapView;
+
+// 청크 중 [offset, offset + size) 범위 변환 (범위는 view 안에 있어야 함)
+// 저널 진행 바이트는 청크 시작(chunk_start) 기준, sum이 있으면 CRC32C를 이어서 누적
+static int transform_range(const KeyStream *ks, const MapView *view, off_t chunk_start,
+                           off_t offset, size_t size, int chunk_id,
+                           Journal *journal, int out_fd, ChunkChecksum *sum,
+                           SharedData *shared, int worker_id) {
+    size_t rel = offset - view->start;     // 매핑 안에서의 위치
+    const unsigned char *chunk_src = view->src + rel;
+    unsigned char *chunk_dst = view->dst + rel;
+    int in_place = (view->src == view->dst);
 
     // 진행률 표시를 위한 중간 보고 (큰 파일의 경우)
-    size_t chunk_size = task.size;
-    size_t progress_interval = chunk_size / 10;  // 10% 단위로 보고
+    size_t progress_interval = size / 10;  // 10% 단위로 보고
     if (progress_interval < 1024 * 1024) {
-        progress_interval = chunk_size;  // 작은 청크는 한 번에
+        progress_interval = size;  // 작은 청크는 한 번에
+    }
+    if (journal && progress_interval > JOURNAL_BLOCK_SIZE) {
+        progress_interval = JOURNAL_BLOCK_SIZE;  // 저널은 블록 단위로 갱신
+    }
+    int behind = !journal && out_fd != -1 && durability_mode == DURABILITY_WRITEBEHIND;
+    if (behind && progress_interval > WRITEBEHIND_BLOCK_SIZE) {
+        progress_interval = WRITEBEHIND_BLOCK_SIZE;
+    }
+    if (progress_interval > PREFETCH_BLOCK_SIZE) {
+        progress_interval = PREFETCH_BLOCK_SIZE;  // 다음 블록을 미리 읽는 단위
     }
 
-    printf("[Worker %d] Processing chunk %d (%zu bytes)...\n",
-           worker_id, task.chunk_id, chunk_size);
+    // --populate: 범위 전체의 페이지 테이블을 한 번에 채워 블록마다 폴트가 나지 않게 함
+    // (빈 블록이 있는 청크는 쓰기 폴트가 구멍을 할당하므로 출력은 채우지 않음)
+    if (map_populate) {
+        populate_range(chunk_src, size, 0);
+        if (!in_place && !(sum && sum->holes)) populate_range(chunk_dst, size, 1);
+    }
 
-    if (task.operation == 'e') {
-        // 암호화
-        for (size_t processed = 0; processed < chunk_size; processed += progress_interval) {
-            size_t block_size = (processed + progress_interval > chunk_size) ?
-                                (chunk_size - processed) : progress_interval;
+    for (size_t processed = 0; processed < size; processed += progress_interval) {
+        size_t block_size = (processed + progress_interval > size) ?
+                            (size - processed) : progress_interval;
 
-            xor_encrypt(chunk_start + processed, block_size, task.key);
+        // 이 블록을 처리하는 동안 다음 블록(범위 끝이면 파일상 다음 청크 앞부분)을 미리 읽음
+        // 매핑 밖이면 페이지 캐시로만 읽어 둠
+        size_t next = rel + processed + block_size;
+        if (next < view->size) {
+            advise_range(view->src, view->size, next, progress_interval, MADV_WILLNEED);
+        } else if (view->prefetch_fd != -1) {
+            posix_fadvise(view->prefetch_fd, view->in_data + view->start + next,
+                          progress_interval, POSIX_FADV_WILLNEED);
+        }
 
-            // 진행률 업데이트
-            pthread_mutex_lock(&shared->mutex);
-            shared->worker_progress[worker_id] = (double)(processed + block_size) / chunk_size;
-            pthread_mutex_unlock(&shared->mutex);
+        // 파일 내 절대 오프셋을 넘겨 청크 경계와 무관하게 키 위상 유지
+        if (sum) {
+            xor_transform_sum(ks, chunk_dst + processed, chunk_src + processed,
+                              block_size, offset + processed, sum);
+        } else if (view->use_nt) {
+            xor_transform_nt(ks, chunk_dst + processed, chunk_src + processed,
+                             block_size, offset + processed);
+        } else {
+            xor_transform(ks, chunk_dst + processed, chunk_src + processed,
+                          block_size, offset + processed);
         }
-    } else {
-        // 복호화
-        for (size_t processed = 0; processed < chunk_size; processed += progress_interval) {
-            size_t block_size = (processed + progress_interval > chunk_size) ?
-                                (chunk_size - processed) : progress_interval;
 
-            xor_decrypt(chunk_start + processed, block_size, task.key);
+        if (journal) {
+            if (sync_range(view->dst, rel + processed, block_size) == -1) {
+                perror("msync");
+                return -1;
+            }
+            journal_update(journal, chunk_id, offset - chunk_start + processed + block_size,
+                           CHUNK_ACTIVE);
+        } else if (behind) {
+            write_behind(out_fd, view->out_data + offset + processed, block_size,
+                         processed > 0 ? progress_interval : 0);
+        }
 
-            // 진행률 업데이트
-            pthread_mutex_lock(&shared->mutex);
-            shared->worker_progress[worker_id] = (double)(processed + block_size) / chunk_size;
-            pthread_mutex_unlock(&shared->mutex);
+        // 진행률 업데이트 (자기 슬롯만 갱신하므로 잠금 불필요)
+        if (shared) {
+            atomic_fetch_add_explicit(&shared->workers[worker_id].bytes_done,
+                                      block_size, memory_order_relaxed);
+        }
+
+        // 지나간 블록은 다시 접근하지 않으므로 페이지 테이블에서 내림
+        // (공유 파일 매핑이라 더티 상태는 페이지 캐시에 남고, msync는 파일 범위를 동기화)
+        advise_range(view->src, view->size, rel + processed, block_size, MADV_DONTNEED);
+        if (!in_place) {
+            advise_range(view->dst, view->size, rel + processed, block_size, MADV_DONTNEED);
         }
     }
 
     // 메모리 동기화 (디스크에 기록) (교안 ch09 기반)
-    printf("[Worker %d] Syncing chunk %d to disk...\n", worker_id, task.chunk_id);
-    if (msync(chunk_start, chunk_size, MS_SYNC) == -1) {
-        perror("[Worker] msync");
+    if (!journal && durability_mode == DURABILITY_CHUNK &&
+        sync_range(view->dst, rel, size) == -1) {
+        perror("msync");
+        return -1;
+    }
+
+    return 0;
+}
+
+// 청크 하나 변환 (파일 전체를 매핑한 스레드 엔진, 단일 프로세스 모드용)
+// src_base == dst_base 이면 제자리 변환이며, journal이 있으면 블록마다
+// "데이터 동기화 → 저널 갱신" 순서로 진행 상황을 기록
+// 저널이 없으면 durability_mode에 따라 청크 끝에 동기화하거나(chunk),
+// out_fd로 블록마다 write-behind 기록을 시작(writebehind)
+// src_base / dst_base는 데이터 시작을 가리키고, out_data는 out_fd에서 데이터 시작 위치
+// sum이 있으면 변환하면서 청크의 CRC32C를 계산
+int transform_chunk(const KeyStream *ks, const unsigned char *src_base,
+                    unsigned char *dst_base, size_t map_size,
+                    off_t offset, size_t size, int chunk_id,
+                    Journal *journal, int out_fd, off_t out_data,
+                    ChunkChecksum *sum, SharedData *shared, int worker_id) {
+    // LLC보다 큰 출력은 캐시를 우회하는 비시간적 저장 사용
+    // (제자리 변환은 방금 읽은 라인에 쓰므로 일반 저장이 유리)
+    MapView view = {
+        .src = src_base, .dst = dst_base, .start = 0, .size = map_size,
+        .out_data = out_data,
+        .use_nt = src_base != dst_base && map_size > crypto_nt_threshold(),
+        .prefetch_fd = -1,
+    };
+
+    journal_update(journal, chunk_id, 0, CHUNK_ACTIVE);
+    if (transform_range(ks, &view, offset, offset, size, chunk_id,
+                        journal, out_fd, sum, shared, worker_id) == -1) {
+        return -1;
+    }
+    journal_update(journal, chunk_id, size, CHUNK_DONE);
+    return 0;
+}
+
+// 청크 하나 변환 (워커 프로세스: 청크 범위만 매핑)
+// 파일 전체를 워커마다 매핑하면 매핑 비용과 주소 공간이 "파일 크기 × 워커 수"로 늘어나므로
+// 청크가 걸친 페이지만 매핑하고 끝나면 해제한다. 청크가 MAP_WINDOW_SIZE보다 크면
+// 창을 옮겨 가며 매핑하므로 한 번에 매핑하는 양은 입력 / 출력 창 하나씩으로 제한된다.
+// in_fd == out_fd 이면 제자리 변환
+// 데이터는 입력 / 출력 파일의 in_data / out_data부터 (페이지 배수, 원시 파일은 0)
+static int transform_chunk_windowed(const KeyStream *ks, int in_fd, int out_fd,
+                                    off_t in_data, off_t out_data,
+                                    size_t file_size, off_t offset, size_t size,
+                                    int chunk_id, Journal *journal, int sync_fd,
+                                    ChunkChecksum *sum, SharedData *shared, int worker_id) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    int in_place = (in_fd == out_fd);
+    MapView view = {
+        .in_data = in_data,
+        .out_data = out_data,
+        .use_nt = !in_place && file_size > crypto_nt_threshold(),
+        .prefetch_fd = in_fd,
+    };
+
+    journal_update(journal, chunk_id, 0, CHUNK_ACTIVE);
+
+    for (size_t done = 0; done < size; ) {
+        off_t pos = offset + done;
+        size_t len = size - done < MAP_WINDOW_SIZE ? size - done : MAP_WINDOW_SIZE;
+
+        view.start = pos & ~(off_t)(page_size - 1);
+        view.size = pos + len - view.start;
+        unsigned char *src = map_file_range(in_fd, in_data + view.start, view.size, in_place);
+        if (!src) {
+            return -1;
+        }
+        unsigned char *dst = src;
+        if (!in_place) {
+            dst = map_file_range(out_fd, out_data + view.start, view.size, 1);
+            if (!dst) {
+                unmap_file(src, view.size);
+                return -1;
+            }
+        }
+        view.src = src;
+        view.dst = dst;
+
+        int result = transform_range(ks, &view, offset, pos, len, chunk_id,
+                                     journal, sync_fd, sum, shared, worker_id);
+
+        unmap_file(src, view.size);
+        if (!in_place) unmap_file(dst, view.size);
+        if (result == -1) {
+            return -1;
+        }
+        done += len;
+    }
+
+    journal_update(journal, chunk_id, size, CHUNK_DONE);
+    return 0;
+}
+
+// 워커별 열린 파일 캐시
+// 같은 파일의 청크를 여러 번 받아도 다시 열지 않도록 (경로, 쓰기 여부)로 보관
+// inode나 크기가 바뀐 파일(다시 생성된 출력 등)은 다시 엶
+#define FILE_CACHE_SIZE 8
+
+typedef struct {
+    char path[MAX_PATH_LEN];    // 빈 문자열이면 빈 슬롯
+    int writable;
+    dev_t dev;
+    ino_t ino;
+    size_t size;
+    int fd;
+    unsigned long last_used;
+} OpenFile;
+
+static OpenFile file_cache[FILE_CACHE_SIZE];
+static unsigned long file_clock = 0;
+
+static void cache_release(OpenFile *entry) {
+    close(entry->fd);
+    entry->path[0] = '\0';
+}
+
+// 캐시에서 파일 fd를 찾거나 새로 엶 (실패 시 -1)
+static int cache_open_file(const char *path, int writable, size_t *size) {
+    struct stat statbuf;
+    if (stat(path, &statbuf) == -1) {
+        perror("stat");
+        return -1;
+    }
+
+    OpenFile *victim = &file_cache[0];
+    for (int i = 0; i < FILE_CACHE_SIZE; i++) {
+        OpenFile *entry = &file_cache[i];
+
+        if (entry->path[0] && entry->writable == writable &&
+            strcmp(entry->path, path) == 0) {
+            if (entry->dev == statbuf.st_dev && entry->ino == statbuf.st_ino &&
+                entry->size == (size_t)statbuf.st_size) {
+                entry->last_used = ++file_clock;
+                *size = entry->size;
+                return entry->fd;
+            }
+            victim = entry;  // 같은 경로의 오래된 fd는 교체
+            break;
+        }
+
+        // 빈 슬롯 우선, 없으면 가장 오래 사용하지 않은 슬롯
+        if (victim->path[0] && (!entry->path[0] || entry->last_used < victim->last_used)) {
+            victim = entry;
+        }
+    }
+
+    if (victim->path[0]) {
+        cache_release(victim);
+    }
+
+    int fd = open(path, (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd == -1) {
+        perror("open");
+        return -1;
+    }
+    if (fstat(fd, &statbuf) == -1) {
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+
+    // 청크 안에서는 순차 접근: 이 파일의 readahead 창을 키움
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    strncpy(victim->path, path, sizeof(victim->path) - 1);
+    victim->path[sizeof(victim->path) - 1] = '\0';
+    victim->writable = writable;
+    victim->dev = statbuf.st_dev;
+    victim->ino = statbuf.st_ino;
+    victim->size = statbuf.st_size;
+    victim->fd = fd;
+    victim->last_used = ++file_clock;
+    *size = victim->size;
+    return fd;
+}
+
+static void cache_release_all(void) {
+    for (int i = 0; i < FILE_CACHE_SIZE; i++) {
+        if (file_cache[i].path[0]) {
+            cache_release(&file_cache[i]);
+        }
+    }
+}
+
+// direct I/O: 입력 / 출력 파일 열기 (같은 파일의 청크가 이어지면 열린 fd 재사용)
+static int worker_open_direct(int worker_id, const WorkTask *task, DirectFiles *direct) {
+    static char in_path[MAX_PATH_LEN], out_path[MAX_PATH_LEN];
+
+    if (direct->in_fd == -1 || strcmp(in_path, task->input_file) != 0 ||
+        strcmp(out_path, task->output_file) != 0) {
+        direct_close(direct);
+        if (direct_open(direct, task->input_file, task->output_file) == -1) {
+            fprintf(stderr, "[Worker %d] Failed to open files for direct I/O\n", worker_id);
+            return -1;
+        }
+        // 디렉터리 모드(TASK_RUN)는 main이 미리 확인할 파일이 없으므로 여기서 안내
+        if (!direct->direct && task->type == TASK_RUN) {
+            printf("[Worker %d] '%s' does not support O_DIRECT, "
+                   "using buffered I/O with POSIX_FADV_DONTNEED\n", worker_id, task->input_file);
+        }
+        memcpy(in_path, task->input_file, sizeof(in_path));
+        memcpy(out_path, task->output_file, sizeof(out_path));
+    }
+    direct->in_data = task->in_data;
+    direct->out_data = task->out_data;
+
+    struct stat statbuf;
+    if (fstat(direct->in_fd, &statbuf) == -1 ||
+        (size_t)statbuf.st_size < task->in_data + task->file_size) {
+        fprintf(stderr, "[Worker %d] File size changed (expected %zu bytes)\n",
+                worker_id, task->file_size);
+        return -1;
+    }
+    return 0;
+}
+
+// 작업에 필요한 입력 / 출력 파일 준비
+static int worker_open_files(int worker_id, const WorkTask *task,
+                             int *in_fd, int *out_fd) {
+    // 제자리 모드는 입력 하나만 쓰기 가능으로
+    size_t in_size, out_size;
+    *in_fd = cache_open_file(task->input_file, task->in_place, &in_size);
+    if (*in_fd == -1) {
+        fprintf(stderr, "[Worker %d] Failed to open input file\n", worker_id);
+        return -1;
+    }
+
+    *out_fd = *in_fd;
+    out_size = in_size;
+    if (!task->in_place) {
+        *out_fd = cache_open_file(task->output_file, 1, &out_size);
+        if (*out_fd == -1) {
+            fprintf(stderr, "[Worker %d] Failed to open output file\n", worker_id);
+            return -1;
+        }
+    }
+
+    // 컨테이너는 헤더와 인덱스만큼 더 큼
+    if (in_size < task->in_data + task->file_size ||
+        out_size < task->out_data + task->file_size) {
+        fprintf(stderr, "[Worker %d] File size changed (expected %zu bytes)\n",
+                worker_id, task->file_size);
+        return -1;
+    }
+
+    return 0;
+}
+
+// 마스터가 만든 저널 열기 (제자리 모드의 출력은 입력 파일 자신)
+//  - 제자리 모드: 자기 청크 엔트리 갱신
+//  - 재개(--resume): 출력의 진행 기록에서 완료된 청크를 건너뜀 (기록은 마스터가)
+static int worker_open_journal(const WorkTask *task, Journal *journal) {
+    char path[MAX_PATH_LEN + 16];
+    snprintf(path, sizeof(path), "%s.journal", task->output_file);
+    if (journal->header && strcmp(journal->path, path) != 0) {
+        journal_close(journal);
+    }
+    if (!journal->header && journal_open(journal, task->output_file) == -1) {
+        return -1;
     }
+    return 0;
+}
 
-    // 진행 상황 보고
+// 작업에 필요한 파일(매핑용 fd 또는 direct I/O 파일), 저널, 키스트림 준비
+// direct I/O로 처리하면 *in_fd, *out_fd는 -1
+// *sync_fd는 write-behind 정책에서 출력 파일 fd (그 외 -1)
+static int worker_prepare(int worker_id, const WorkTask *task, Journal *journal,
+                          DirectFiles *direct, int *in_fd, int *out_fd,
+                          int *sync_fd, const KeyStream **ks_out) {
+    *in_fd = *out_fd = *sync_fd = -1;
+    if (direct_pool && !task->in_place) {
+        if (worker_open_direct(worker_id, task, direct) == -1) {
+            return -1;
+        }
+    } else {
+        if (worker_open_files(worker_id, task, in_fd, out_fd) == -1) {
+            return -1;
+        }
+        if (!task->in_place && durability_mode == DURABILITY_WRITEBEHIND) {
+            *sync_fd = *out_fd;
+        }
+    }
+    if ((task->in_place || task->resume) && worker_open_journal(task, journal) == -1) {
+        return -1;
+    }
+
+    // 키스트림 준비 (키가 바뀔 때만 다시 생성)
+    // XOR은 자기 역함수이므로 암호화/복호화 동일
+    static KeyStream ks;
+    static char ks_key[sizeof(task->key)] = "";
+    if (strcmp(ks_key, task->key) != 0) {
+        if (keystream_init(&ks, task->key) == -1) {
+            return -1;
+        }
+        memcpy(ks_key, task->key, sizeof(ks_key));
+    }
+    *ks_out = &ks;
+
+    return 0;
+}
+
+// 청크 처리 결과 보고
+int send_report(int write_fd, int chunk_id, int status, uint32_t checksum) {
     ProgressReport report;
-    report.chunk_id = task.chunk_id;
-    report.status = STATUS_DONE;
+    report.chunk_id = chunk_id;
+    report.status = status;
     report.worker_pid = getpid();
-    report.progress = 1.0;
+    report.progress = status == STATUS_DONE ? 1.0 : 0.0;
+    report.checksum = checksum;
 
-    // EINTR 처리
-    ssize_t written;
-    while ((written = write(write_fd, &report, sizeof(ProgressReport))) == -1) {
-        if (errno == EINTR) {
-            continue;
-        }
+    if (write_full(write_fd, &report, sizeof(ProgressReport)) == -1) {
         perror("[Worker] write failed");
-        break;
+        return -1;
+    }
+    return 0;
+}
+
+// 청크 하나 처리 후 공유 메모리 갱신 및 보고 (변환과 보고가 모두 성공해야 0)
+static int worker_do_chunk(int worker_id, int write_fd, SharedData *shared,
+                           const WorkTask *task, const KeyStream *ks,
+                           int in_fd, int out_fd, Journal *journal,
+                           const DirectFiles *direct, int sync_fd,
+                           int chunk_id, off_t offset, size_t size) {
+    // 공유 메모리 업데이트: 작업 시작
+    WorkerSlot *slot = &shared->workers[worker_id];
+    atomic_store_explicit(&slot->status, STATUS_WORKING, memory_order_relaxed);
+
+    // 컨테이너 청크: 변환하면서 CRC32C를 계산해 완료 보고에 실어 보냄
+    ChunkChecksum checksum;
+    chunk_checksum_init(&checksum, task->checksum, chunk_id);
+    ChunkChecksum *sum = task->checksum != CHECKSUM_NONE ? &checksum : NULL;
+
+    int result;
+    if (in_fd == -1) {
+        result = direct_transform_chunk(direct_pool, ks, direct, task->file_size,
+                                        offset, size, sum, shared, worker_id);
+    } else {
+        result = transform_chunk_windowed(ks, in_fd, out_fd, task->in_data, task->out_data,
+                                          task->file_size, offset, size, chunk_id,
+                                          task->in_place ? journal : NULL, sync_fd,
+                                          sum, shared, worker_id);
     }
 
     // 공유 메모리 업데이트: 작업 완료
-    pthread_mutex_lock(&shared->mutex);
-    shared->completed_chunks++;
-    shared->worker_status[worker_id] = STATUS_DONE;
-    shared->worker_progress[worker_id] = 1.0;
-    pthread_mutex_unlock(&shared->mutex);
+    atomic_store_explicit(&slot->status, result == 0 ? STATUS_DONE : STATUS_ERROR,
+                          memory_order_relaxed);
+    if (result == 0) {
+        atomic_fetch_add_explicit(&slot->chunks_done, 1, memory_order_release);
+    }
+
+    if (send_report(write_fd, chunk_id, result == 0 ? STATUS_DONE : STATUS_ERROR,
+                    checksum.value) == -1) {
+        return -1;
+    }
+    return result;
+}
+
+// 워커 프로세스 메인 함수 (교안 ch07, ch10 기반)
+// TASK_SHUTDOWN을 받을 때까지 작업 파이프에서 반복해서 작업을 받아 처리
+//  - TASK_RUN: 지정된 청크 하나 처리 (디렉터리 모드: 작은 파일은 파일 전체가 청크 하나)
+//  - TASK_JOB: 공유 메모리의 원자적 커서에서 청크 번호를 하나씩 가져와 파일이 끝날 때까지 처리
+//    (빨리 끝난 워커가 계속 일을 가져가므로 가장 느린 워커가 전체 시간을 결정하지 않음)
+// 작업마다 청크별 보고 후 마지막에 STATUS_IDLE을 보내 다음 작업을 받을 수 있음을 알림
+void worker_main(int worker_id, int read_fd, int write_fd,
+                 SharedData *shared) {
+    printf("[Worker %d] Started (PID: %d, PPID: %d)\n",
+           worker_id, getpid(), getppid());
+
+    // io_uring 백엔드: 링을 준비하지 못하면 아래 mmap 경로로 처리
+    if (use_io_uring) {
+        int uring_chunks = uring_worker_main(worker_id, read_fd, write_fd, shared);
+        if (uring_chunks >= 0) {
+            printf("[Worker %d] Shutting down after %d chunks (io_uring)\n",
+                   worker_id, uring_chunks);
+            exit(0);
+        }
+    }
+
+    Journal journal = { .fd = -1 };
+    DirectFiles direct = { .in_fd = -1, .out_fd = -1 };
+    int chunks_done = 0;
+
+    while (1) {
+        // 작업 수신 대기 (EINTR은 read_full에서 재시도)
+        WorkTask task;
+        ssize_t n = read_full(read_fd, &task, sizeof(WorkTask));
+
+        if (n == -1) {
+            perror("[Worker] read failed");
+            break;
+        }
+        if (n != sizeof(WorkTask)) {
+            if (n != 0) {
+                fprintf(stderr, "[Worker %d] Failed to read task (got %zd bytes, expected %zu)\n",
+                        worker_id, n, sizeof(WorkTask));
+            }
+            break;  // 마스터가 파이프를 닫음
+        }
+
+        if (task.type == TASK_SHUTDOWN) {
+            break;
+        }
+
+        int in_fd, out_fd, sync_fd;
+        const KeyStream *ks;
+        int prepared = worker_prepare(worker_id, &task, &journal, &direct,
+                                      &in_fd, &out_fd, &sync_fd, &ks);
+
+        if (task.type == TASK_RUN) {
+            if (prepared == -1 || (size_t)task.offset + task.size > task.file_size) {
+                report_error(write_fd, task.chunk_id);
+            } else if (worker_do_chunk(worker_id, write_fd, shared, &task, ks,
+                                       in_fd, out_fd, &journal,
+                                       &direct, sync_fd, task.chunk_id,
+                                       task.offset, task.size) == 0) {
+                chunks_done++;
+            }
+        } else {
+            // 원자적 커서에서 다음 청크 번호를 가져옴 (잠금 없음)
+            int chunk_id;
+            while ((chunk_id = atomic_fetch_add(&shared->next_chunk, 1)) < task.num_chunks) {
+                if (atomic_load(&shared->shutdown_flag)) {
+                    break;
+                }
+                if (task.resume && journal_chunk_is_done(&journal, chunk_id)) {
+                    continue;   // 이전 실행에서 완료된 청크
+                }
+
+                off_t offset = (off_t)chunk_id * task.chunk_size;
+                size_t size = task.file_size - offset < task.chunk_size ?
+                              task.file_size - offset : task.chunk_size;
+
+                if (prepared == -1) {
+                    report_error(write_fd, chunk_id);
+                    continue;
+                }
+                if (worker_do_chunk(worker_id, write_fd, shared, &task, ks,
+                                    in_fd, out_fd, &journal,
+                                    &direct, sync_fd, chunk_id, offset, size) == 0) {
+                    chunks_done++;
+                }
+            }
+        }
+
+        // 작업 종료: 다음 작업을 받을 준비가 됨
+        if (send_report(write_fd, -1, STATUS_IDLE, 0) == -1) {
+            break;
+        }
+    }
 
-    // 메모리 매핑 해제
-    unmap_file(mapped_data, file_size);
+    // 열린 파일 닫기
+    cache_release_all();
+    journal_close(&journal);
+    direct_close(&direct);
 
-    printf("[Worker %d] Completed chunk %d\n", worker_id, task.chunk_id);
+    printf("[Worker %d] Shutting down after %d chunks\n", worker_id, chunks_done);
     exit(0);
 }
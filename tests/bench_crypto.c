@@ -0,0 +1,231 @@
+// 암호화 커널 마이크로벤치마크
+// fork/mmap/복사/msync 비용 없이 메모리 버퍼 위에서 커널 처리량만 측정
+//
+// 사용법: ./tests/bench_crypto [trials]
+//   - 버퍼 크기: L1 / L2 / LLC / DRAM
+//   - 키 길이, 버퍼 정렬 어긋남(misalignment) 스윕
+//   - 각 조합을 여러 번 반복해 중앙값(median)으로 GB/s, cycles/byte 보고
+#include "crypto_system.h"
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#define DEFAULT_TRIALS 9
+#define MIN_BYTES_PER_TRIAL (256UL * 1024 * 1024)  // 트라이얼당 최소 처리량
+
+static int num_trials = DEFAULT_TRIALS;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t now_cycles(void) {
+#ifdef HAVE_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static size_t cache_size(int name, size_t fallback) {
+    long v = sysconf(name);
+    return v > 0 ? (size_t)v : fallback;
+}
+
+// 지정한 길이의 키로 키스트림 생성
+static void make_keystream(KeyStream *ks, size_t key_len) {
+    static const char key_chars[] =
+        "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    char key[MAX_KEY_LEN + 1];
+
+    for (size_t i = 0; i < key_len; i++) {
+        key[i] = key_chars[i % (sizeof(key_chars) - 1)];
+    }
+    key[key_len] = '\0';
+
+    keystream_init(ks, key);
+}
+
+// 커널 하나를 (크기, 키, 정렬) 조합으로 측정
+// dst == NULL 이면 제자리 변환, 아니면 buf -> dst 변환
+static void bench_one(const char *name, xor_kernel_fn fn, const char *label,
+                      unsigned char *buf, unsigned char *dst, size_t size,
+                      size_t misalign, const KeyStream *ks) {
+    unsigned char *data = buf + misalign;
+    unsigned char *out = dst ? dst + misalign : data;
+    size_t reps = MIN_BYTES_PER_TRIAL / size;
+    if (reps == 0) reps = 1;
+
+    double secs[num_trials], cpb[num_trials];
+
+    // 워밍업 (페이지 폴트, 캐시 적재)
+    fn(out, data, size, ks->stream, 0, ks->period);
+
+    for (int t = 0; t < num_trials; t++) {
+        double t0 = now_sec();
+        uint64_t c0 = now_cycles();
+
+        for (size_t r = 0; r < reps; r++) {
+            fn(out, data, size, ks->stream, r % ks->key_len, ks->period);
+        }
+
+        uint64_t c1 = now_cycles();
+        double t1 = now_sec();
+
+        secs[t] = (t1 - t0) / reps;
+        cpb[t] = (double)(c1 - c0) / ((double)size * reps);
+    }
+
+    qsort(secs, num_trials, sizeof(double), cmp_double);
+    qsort(cpb, num_trials, sizeof(double), cmp_double);
+
+    double median = secs[num_trials / 2];
+    printf("  %-9s %-8s %10zu B  key=%3zu  misalign=%2zu | %7.2f GB/s | %6.3f cycles/B\n",
+           name, label, size, ks->key_len, misalign,
+           size / median / 1e9, cpb[num_trials / 2]);
+}
+
+// ChaCha20 커널 측정 (키와 정렬은 처리량에 영향이 없으므로 크기만)
+static void bench_chacha(const char *name, chacha20_blocks_fn fn, const char *label,
+                         unsigned char *buf, size_t size) {
+    uint32_t state[16];
+    unsigned char key[CHACHA20_KEY_LEN] = { 0 };
+    chacha20_setup(state, key, 0);
+
+    size_t nblocks = size / 64;
+    size_t reps = MIN_BYTES_PER_TRIAL / 8 / size;   // XOR보다 느리므로 반복을 줄임
+    if (reps == 0) reps = 1;
+
+    double secs[num_trials], cpb[num_trials];
+    fn(buf, buf, nblocks, state, 0);
+
+    for (int t = 0; t < num_trials; t++) {
+        double t0 = now_sec();
+        uint64_t c0 = now_cycles();
+
+        for (size_t r = 0; r < reps; r++) {
+            fn(buf, buf, nblocks, state, r * nblocks);
+        }
+
+        uint64_t c1 = now_cycles();
+        double t1 = now_sec();
+
+        secs[t] = (t1 - t0) / reps;
+        cpb[t] = (double)(c1 - c0) / ((double)nblocks * 64 * reps);
+    }
+
+    qsort(secs, num_trials, sizeof(double), cmp_double);
+    qsort(cpb, num_trials, sizeof(double), cmp_double);
+
+    double median = secs[num_trials / 2];
+    printf("  %-9s %-8s %10zu B  chacha20              | %7.2f GB/s | %6.3f cycles/B\n",
+           name, label, nblocks * 64, nblocks * 64 / median / 1e9, cpb[num_trials / 2]);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        num_trials = atoi(argv[1]);
+        if (num_trials < 1) num_trials = DEFAULT_TRIALS;
+    }
+
+    crypto_init();
+
+    size_t l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, 32 * 1024);
+    size_t l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, 1024 * 1024);
+    size_t llc = cache_size(_SC_LEVEL3_CACHE_SIZE, 8 * 1024 * 1024);
+
+    // 각 캐시 레벨에 절반만 들어가게 해서 해당 레벨에서 동작하도록 함
+    size_t dram = llc * 4;
+    if (dram < 64UL * 1024 * 1024) dram = 64UL * 1024 * 1024;
+    if (dram > 512UL * 1024 * 1024) dram = 512UL * 1024 * 1024;
+
+    struct { const char *label; size_t size; } sizes[] = {
+        { "L1",   l1 / 2 },
+        { "L2",   l2 / 2 },
+        { "LLC",  llc / 2 },
+        { "DRAM", dram },
+    };
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    unsigned char *buf = aligned_alloc(4096, dram + 4096);
+    if (!buf) {
+        perror("aligned_alloc");
+        return 1;
+    }
+    for (size_t i = 0; i < dram + 4096; i++) {
+        buf[i] = (unsigned char)(i * 131 + 7);
+    }
+
+    unsigned char *out_buf = aligned_alloc(4096, dram / 2 + 4096);
+    if (!out_buf) {
+        perror("aligned_alloc");
+        free(buf);
+        return 1;
+    }
+    memset(out_buf, 0, dram / 2 + 4096);
+
+    KeyStream ks;
+    size_t key_lens[] = { 1, 7, 16, 64, 255 };
+    size_t misaligns[] = { 0, 1, 13, 32 };
+
+    printf("=== Crypto Kernel Benchmark ===\n");
+    printf("Trials: %d (median reported)\n", num_trials);
+    printf("Caches: L1d=%zu KB, L2=%zu KB, LLC=%zu KB\n",
+           l1 / 1024, l2 / 1024, llc / 1024);
+    printf("Default kernel: %s\n", crypto_kernel_name());
+#ifndef HAVE_RDTSC
+    printf("Note: cycle counter unavailable, cycles/B reported as 0\n");
+#endif
+
+    for (int ki = 0; ki < xor_kernel_count(); ki++) {
+        const XorKernel *k = xor_kernel_get(ki);
+        if (!k->supported()) {
+            printf("\n[%s] not supported on this CPU, skipped\n", k->name);
+            continue;
+        }
+
+        printf("\n[%s] buffer size sweep\n", k->name);
+        make_keystream(&ks, 16);
+        for (int s = 0; s < num_sizes; s++) {
+            bench_one(k->name, k->fn, sizes[s].label, buf, NULL,
+                      sizes[s].size, 0, &ks);
+        }
+
+        // 별도 출력 버퍼로의 변환 (일반 저장 vs 비시간적 저장)
+        printf("[%s] copy-transform, regular vs non-temporal stores\n", k->name);
+        bench_one(k->name, k->fn, "DRAM", buf, out_buf, dram / 2, 0, &ks);
+        bench_one(k->name, k->fn_nt, "DRAM/nt", buf, out_buf, dram / 2, 0, &ks);
+
+        printf("[%s] key length sweep\n", k->name);
+        for (size_t i = 0; i < sizeof(key_lens) / sizeof(key_lens[0]); i++) {
+            make_keystream(&ks, key_lens[i]);
+            bench_one(k->name, k->fn, "L2", buf, NULL, sizes[1].size, 0, &ks);
+        }
+
+        printf("[%s] misalignment sweep\n", k->name);
+        make_keystream(&ks, 16);
+        for (size_t i = 0; i < sizeof(misaligns) / sizeof(misaligns[0]); i++) {
+            bench_one(k->name, k->fn, "L2", buf, NULL, sizes[1].size,
+                      misaligns[i], &ks);
+        }
+
+        printf("[%s] chacha20 buffer size sweep\n", k->name);
+        for (int s = 0; s < num_sizes; s++) {
+            bench_chacha(k->name, k->chacha, sizes[s].label, buf, sizes[s].size);
+        }
+    }
+
+    free(out_buf);
+    free(buf);
+    return 0;
+}
@@ -22,9 +22,13 @@ FILE_SIZES=(1 5 10 50)
 # 워커 수
 WORKER_COUNTS=(1 2 4 8)
 
+# 추가 옵션 (예: EXTRA_OPTS="--affinity numa" ./performance_test.sh)
+EXTRA_OPTS=${EXTRA_OPTS:-}
+
 # 결과 저장
 RESULTS_FILE="performance_results.txt"
 echo "Performance Test Results - $(date)" > $RESULTS_FILE
+[ -n "$EXTRA_OPTS" ] && echo "Options: $EXTRA_OPTS" >> $RESULTS_FILE
 echo "========================================" >> $RESULTS_FILE
 echo "" >> $RESULTS_FILE
 
@@ -56,7 +60,7 @@ for SIZE in "${FILE_SIZES[@]}"; do
 
         # 시간 측정
         START_TIME=$(date +%s.%N)
-        $CRYPTO_SYSTEM -e $TEST_FILE -o $ENCRYPTED_FILE -k "testpassword" -w $WORKERS > /dev/null 2>&1
+        $CRYPTO_SYSTEM -e $TEST_FILE -o $ENCRYPTED_FILE -k "testpassword" -w $WORKERS $EXTRA_OPTS > /dev/null 2>&1
         EXIT_CODE=$?
         END_TIME=$(date +%s.%N)
 